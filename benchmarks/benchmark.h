@@ -0,0 +1,151 @@
+#ifndef LIBTENSOR_BENCHMARK_H
+#define LIBTENSOR_BENCHMARK_H
+
+#include <cstdlib>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace libtensor {
+
+
+/** \brief Base class for benchmarks
+
+    A benchmark prepares its data in setup(), which is not timed, and
+    performs the measured operation in run(). run() must be repeatable: it
+    is invoked once to warm up and then as many times as requested.
+    teardown() releases the data.
+
+    setup() reports the cost of one run() using set_cost(): the number of
+    floating-point operations and the number of bytes read and written.
+    For block tensors with symmetry, the bytes are those of the stored
+    (canonical, non-zero) blocks, the operations are counted as for dense
+    tensors.
+
+    \ingroup libtensor_benchmarks
+ **/
+class benchmark {
+private:
+    std::string m_name; //!< Benchmark name
+    double m_flops; //!< Operations per run
+    double m_bytes; //!< Bytes moved per run
+
+public:
+    benchmark(const std::string &name) :
+        m_name(name), m_flops(0.0), m_bytes(0.0)
+    { }
+
+    virtual ~benchmark() { }
+
+    const std::string &get_name() const {
+        return m_name;
+    }
+
+    double get_flops() const {
+        return m_flops;
+    }
+
+    double get_bytes() const {
+        return m_bytes;
+    }
+
+    virtual void setup() = 0;
+    virtual void run() = 0;
+    virtual void teardown() = 0;
+
+protected:
+    void set_cost(double flops, double bytes) {
+        m_flops = flops;
+        m_bytes = bytes;
+    }
+
+};
+
+
+/** \brief Ordered list of benchmarks (owns the benchmarks)
+
+    \ingroup libtensor_benchmarks
+ **/
+class benchmark_suite {
+private:
+    std::vector<benchmark*> m_lst; //!< Benchmarks
+
+public:
+    ~benchmark_suite() {
+        for(size_t i = 0; i < m_lst.size(); i++) delete m_lst[i];
+    }
+
+    void add(benchmark *b) {
+        m_lst.push_back(b);
+    }
+
+    size_t get_size() const {
+        return m_lst.size();
+    }
+
+    benchmark &get(size_t i) const {
+        return *m_lst[i];
+    }
+
+};
+
+
+/** \brief Result of a benchmark
+
+    \ingroup libtensor_benchmarks
+ **/
+struct benchmark_result {
+    std::string name; //!< Benchmark name
+    size_t nrep; //!< Number of timed runs
+    double tmin; //!< Shortest run time (s)
+    double tmed; //!< Median run time (s)
+    double flops; //!< Operations per run
+    double bytes; //!< Bytes moved per run
+};
+
+
+/** \brief Runs benchmarks and writes the results
+
+    Every benchmark is set up with the same random seed, so the data and
+    the results are reproducible. Rates are computed from the median run
+    time.
+
+    \ingroup libtensor_benchmarks
+ **/
+class benchmark_runner {
+private:
+    size_t m_nrep; //!< Number of timed runs
+    unsigned long m_seed; //!< Random seed
+
+public:
+    benchmark_runner(size_t nrep, unsigned long seed) :
+        m_nrep(nrep), m_seed(seed)
+    { }
+
+    /** \brief Runs one benchmark
+     **/
+    benchmark_result run(benchmark &b);
+
+    /** \brief Writes results in CSV format
+     **/
+    static void write_csv(std::ostream &os,
+        const std::vector<benchmark_result> &res);
+
+    /** \brief Writes results and the environment in JSON format
+     **/
+    static void write_json(std::ostream &os,
+        const std::vector<benchmark_result> &res, size_t nthreads);
+
+};
+
+
+void add_dense_benchmarks(benchmark_suite &s);
+void add_block_benchmarks(benchmark_suite &s);
+void add_expr_benchmarks(benchmark_suite &s);
+void add_linalg_benchmarks(benchmark_suite &s);
+void add_symmetry_benchmarks(benchmark_suite &s);
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BENCHMARK_H
@@ -0,0 +1,155 @@
+#ifndef LIBTENSOR_CC_MODEL_H
+#define LIBTENSOR_CC_MODEL_H
+
+#include <string>
+#include <vector>
+#include <libtensor/core/orbit_list.h>
+#include <libtensor/block_tensor/block_tensor_ctrl.h>
+#include <libtensor/block_tensor/block_tensor_i.h>
+#include <libtensor/symmetry/point_group_table.h>
+#include <libtensor/symmetry/product_table_container.h>
+#include <libtensor/symmetry/se_label.h>
+#include <libtensor/symmetry/se_perm.h>
+
+namespace libtensor {
+
+
+/** \brief Model of the tensors of a coupled-cluster calculation
+
+    Occupied (o) and virtual (v) spaces of a small molecule with C2v
+    symmetry: 20 occupied and 80 virtual orbitals, split into blocks by
+    irreducible representation, larger blocks split once more. Tensors are
+    described by a string of space types, e.g. "oovv" for the doubles
+    amplitudes.
+
+    \ingroup libtensor_benchmarks
+ **/
+class cc_model {
+public:
+    enum {
+        k_no = 20, //!< Number of occupied orbitals
+        k_nv = 80, //!< Number of virtual orbitals
+        k_nblko = 4, //!< Number of occupied blocks
+        k_nblkv = 5 //!< Number of virtual blocks
+    };
+
+public:
+    static const char *get_pgname() {
+        return "c2v_bench";
+    }
+
+    /** \brief Adds the C2v product table if it does not exist yet
+     **/
+    static void init() {
+
+        product_table_container &ptc = product_table_container::get_instance();
+        if(ptc.table_exists(get_pgname())) return;
+
+        product_table_i::label_t a1 = 0, a2 = 1, b1 = 2, b2 = 3;
+        std::vector<std::string> irreps(4);
+        irreps[a1] = "A1"; irreps[a2] = "A2"; irreps[b1] = "B1"; irreps[b2] = "B2";
+        point_group_table pg(get_pgname(), irreps, irreps[a1]);
+        pg.add_product(a1, a1, a1);
+        pg.add_product(a1, a2, a2);
+        pg.add_product(a1, b1, b1);
+        pg.add_product(a1, b2, b2);
+        pg.add_product(a2, a2, a1);
+        pg.add_product(a2, b1, b2);
+        pg.add_product(a2, b2, b1);
+        pg.add_product(b1, b1, a1);
+        pg.add_product(b1, b2, a2);
+        pg.add_product(b2, b2, a1);
+        ptc.add(pg);
+    }
+
+    /** \brief Returns the block index space of a tensor
+        \param types Space types ('o' or 'v').
+     **/
+    template<size_t N>
+    static block_index_space<N> make_bis(const char *types) {
+
+        static const size_t splo[k_nblko - 1] = { 8, 10, 14 };
+        static const size_t splv[k_nblkv - 1] = { 14, 28, 40, 60 };
+
+        index<N> i1, i2;
+        mask<N> mo, mv;
+        for(size_t i = 0; i < N; i++) {
+            bool occ = (types[i] == 'o');
+            i2[i] = (occ ? k_no : k_nv) - 1;
+            mo[i] = occ;
+            mv[i] = !occ;
+        }
+        block_index_space<N> bis(dimensions<N>(index_range<N>(i1, i2)));
+        for(size_t i = 0; i < k_nblko - 1; i++) bis.split(mo, splo[i]);
+        for(size_t i = 0; i < k_nblkv - 1; i++) bis.split(mv, splv[i]);
+        return bis;
+    }
+
+    /** \brief Installs the symmetry of a totally symmetric tensor
+        \param bt Block tensor.
+        \param types Space types ('o' or 'v').
+        \param asym Whether the tensor is antisymmetric with respect to
+            the permutation of pairs of indexes of the same type (0-1,
+            2-3, ...).
+     **/
+    template<size_t N>
+    static void set_symmetry(block_tensor_wr_i<N, double> &bt,
+        const char *types, bool asym) {
+
+        static const product_table_i::label_t lo[k_nblko] = { 0, 1, 2, 3 };
+        static const product_table_i::label_t lv[k_nblkv] = { 0, 0, 1, 2, 3 };
+
+        init();
+
+        block_tensor_wr_ctrl<N, double> ctrl(bt);
+        symmetry<N, double> &sym = ctrl.req_symmetry();
+
+        if(asym) {
+            for(size_t i = 0; i + 1 < N; i += 2) {
+                if(types[i] != types[i + 1]) continue;
+                permutation<N> p;
+                p.permute(i, i + 1);
+                sym.insert(se_perm<N, double>(p, scalar_transf<double>(-1.0)));
+            }
+        }
+
+        se_label<N, double> sl(bt.get_bis().get_block_index_dims(),
+            get_pgname());
+        block_labeling<N> &bl = sl.get_labeling();
+        mask<N> mo, mv;
+        bool anyo = false, anyv = false;
+        for(size_t i = 0; i < N; i++) {
+            if(types[i] == 'o') mo[i] = anyo = true;
+            else mv[i] = anyv = true;
+        }
+        if(anyo) for(size_t i = 0; i < k_nblko; i++) bl.assign(mo, i, lo[i]);
+        if(anyv) for(size_t i = 0; i < k_nblkv; i++) bl.assign(mv, i, lv[i]);
+        sl.set_rule(0);
+        sym.insert(sl);
+    }
+
+    /** \brief Returns the number of bytes in the stored (canonical,
+            non-zero) blocks of a block tensor
+     **/
+    template<size_t N>
+    static double get_stored_bytes(block_tensor_rd_i<N, double> &bt) {
+
+        block_tensor_rd_ctrl<N, double> ctrl(bt);
+        orbit_list<N, double> ol(ctrl.req_const_symmetry());
+        double sz = 0.0;
+        for(typename orbit_list<N, double>::iterator i = ol.begin();
+            i != ol.end(); ++i) {
+            index<N> bidx;
+            ol.get_index(i, bidx);
+            if(ctrl.req_is_zero_block(bidx)) continue;
+            sz += bt.get_bis().get_block_dims(bidx).get_size();
+        }
+        return sz * sizeof(double);
+    }
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_CC_MODEL_H
@@ -10,12 +10,14 @@
 #include "btod_diag.h"
 #include "btod_dirsum.h"
 #include "btod_dotprod.h"
+#include "btod_ewise.h"
 #include "btod_ewmult2.h"
 #include "btod_export.h"
 #include "btod_extract.h"
 #include "btod_mult.h"
 #include "btod_mult1.h"
 #include "btod_random.h"
+#include "btod_reblock.h"
 #include "btod_scale.h"
 #include "btod_select.h"
 #include "btod_set_diag.h"
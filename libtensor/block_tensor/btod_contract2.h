@@ -137,6 +137,32 @@ public:
     //@}
 
     void perform(block_tensor_i<NC, double> &btc, double d);
+
+    /** \brief Estimates the number of block contractions and floating-point
+            operations without computing the contraction
+     **/
+    void get_cost(size_t &npairs, double &nflops) {
+
+        m_gbto.get_cost(npairs, nflops);
+    }
+
+    /** \brief Skips block contractions whose product of block norms is
+            below the threshold (zero turns screening off)
+        \sa gen_bto_contract2::set_screening()
+     **/
+    void set_screening(double thresh) {
+
+        m_gbto.set_screening(thresh);
+    }
+
+    /** \brief Returns the number of skipped block contractions, their
+            floating-point operations, and the bound for the error
+     **/
+    void get_screening_stats(size_t &npairs, double &nflops,
+        double &err) const {
+
+        m_gbto.get_screening_stats(npairs, nflops, err);
+    }
 };
 
 
@@ -0,0 +1,177 @@
+#ifndef LIBTENSOR_BTOD_EWISE_H
+#define LIBTENSOR_BTOD_EWISE_H
+
+#include <vector>
+#include <libtensor/timings.h>
+#include <libtensor/core/noncopyable.h>
+#include <libtensor/core/scalar_transf_double.h>
+#include <libtensor/block_tensor/btod_traits.h>
+#include <libtensor/gen_block_tensor/additive_gen_bto.h>
+
+namespace libtensor {
+
+
+/** \brief Fused element-wise operation on block tensors
+    \tparam N Tensor order.
+
+    Computes an element-wise expression of block tensors that share the
+    block structure of the result, made of sums, products and quotients of
+    permuted and scaled arguments, in one pass over the canonical blocks of
+    the result. For each block the blocks of all the arguments are read
+    once, combined in temporary blocks and written once to the output. This
+    replaces one pass over the whole result for each operation of the
+    expression, as done by btod_sum or btod_mult.
+
+    The expression is given in postfix form. The constructor and push()
+    put an argument on the stack, add(), mult() and div() replace the two
+    topmost entries with their sum, product or quotient. The operation is
+    ready when there is one entry left.
+
+    The symmetry of the result is built the same way as by btod_sum for
+    sums and btod_mult for products and quotients. Blocks of the result are
+    zero if all the terms of a sum are zero, if any factor of a product is
+    zero or if the dividend is zero. Zero blocks in divisors are not
+    allowed.
+
+    \ingroup libtensor_block_tensor_btod
+ **/
+template<size_t N>
+class btod_ewise :
+    public additive_gen_bto<N, btod_traits::bti_traits>,
+    public timings< btod_ewise<N> >,
+    public noncopyable {
+
+public:
+    static const char k_clazz[]; //!< Class name
+
+public:
+    typedef btod_traits::bti_traits bti_traits;
+
+private:
+    enum {
+        k_push, //!< Put an argument on the stack
+        k_add, //!< Replace two topmost entries with their sum
+        k_mult, //!< Replace two topmost entries with their product
+        k_div //!< Replace two topmost entries with their quotient
+    };
+
+    struct arg_type {
+        block_tensor_rd_i<N, double> *bt; //!< Argument
+        tensor_transf<N, double> tr; //!< Transformation of the argument
+
+        arg_type(block_tensor_rd_i<N, double> &bt_,
+            const tensor_transf<N, double> &tr_) :
+            bt(&bt_), tr(tr_)
+        { }
+    };
+
+    struct instr_type {
+        int op; //!< Operation
+        size_t arg; //!< Argument (k_push only)
+
+        instr_type(int op_, size_t arg_) : op(op_), arg(arg_) { }
+    };
+
+private:
+    block_index_space<N> m_bis; //!< Block index space of the result
+    dimensions<N> m_bidims; //!< Block index dimensions
+    std::vector<arg_type> m_args; //!< Arguments
+    std::vector<instr_type> m_prog; //!< Expression in postfix form
+    std::vector< symmetry<N, double>* > m_syms; //!< Symmetry of entries
+    size_t m_depth; //!< Maximum depth of the stack
+    mutable bool m_dirty_sch; //!< Whether the schedule is out of date
+    mutable assignment_schedule<N, double> *m_sch; //!< Schedule
+
+public:
+    //! \name Construction and destruction
+    //@{
+
+    /** \brief Initializes the operation with the first argument
+        \param bt Argument.
+        \param tr Transformation of the argument.
+     **/
+    btod_ewise(block_tensor_rd_i<N, double> &bt,
+        const tensor_transf<N, double> &tr = tensor_transf<N, double>());
+
+    /** \brief Virtual destructor
+     **/
+    virtual ~btod_ewise();
+
+    /** \brief Puts an argument on the stack
+        \param bt Argument.
+        \param tr Transformation of the argument.
+     **/
+    void push(block_tensor_rd_i<N, double> &bt,
+        const tensor_transf<N, double> &tr = tensor_transf<N, double>());
+
+    /** \brief Replaces the two topmost entries with their sum
+     **/
+    void add();
+
+    /** \brief Replaces the two topmost entries with their product
+     **/
+    void mult();
+
+    /** \brief Replaces the two topmost entries with their quotient, the
+            topmost entry is the divisor
+     **/
+    void div();
+
+    //@}
+
+    //! \name Implementation of libtensor::direct_gen_bto<N, bti_traits>
+    //@{
+
+    virtual const block_index_space<N> &get_bis() const {
+        return m_bis;
+    }
+
+    virtual const symmetry<N, double> &get_symmetry() const;
+
+    virtual const assignment_schedule<N, double> &get_schedule() const;
+
+    virtual void perform(gen_block_stream_i<N, bti_traits> &out);
+
+    //@}
+
+    //! \name Implementation of libtensor::additive_gen_bto<N, bti_traits>
+    //@{
+
+    virtual void perform(gen_block_tensor_i<N, bti_traits> &btb);
+
+    virtual void perform(gen_block_tensor_i<N, bti_traits> &btb,
+        const scalar_transf<double> &c);
+
+    virtual void compute_block(
+        bool zero,
+        const index<N> &ib,
+        const tensor_transf<N, double> &trb,
+        dense_tensor_wr_i<N, double> &blkb);
+
+    virtual void compute_block(
+        const index<N> &ib,
+        dense_tensor_wr_i<N, double> &blkb) {
+
+        compute_block(true, ib, tensor_transf<N, double>(), blkb);
+    }
+
+    //@}
+
+    /** \brief Computes a canonical block of the result into the given block
+            of the same dimensions (may be called concurrently)
+     **/
+    void compute_block_untimed(const index<N> &ib,
+        dense_tensor_wr_i<N, double> &blkb);
+
+private:
+    void combine(int op);
+    void make_schedule() const;
+    bool fetch_arg(size_t iarg, const index<N> &ib,
+        dense_tensor_wr_i<N, double> &blk);
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BTOD_EWISE_H
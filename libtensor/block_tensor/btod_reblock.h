@@ -0,0 +1,144 @@
+#ifndef LIBTENSOR_BTOD_REBLOCK_H
+#define LIBTENSOR_BTOD_REBLOCK_H
+
+#include <vector>
+#include <libtensor/timings.h>
+#include <libtensor/core/noncopyable.h>
+#include <libtensor/core/scalar_transf_double.h>
+#include <libtensor/core/split_points.h>
+#include <libtensor/block_tensor/btod_traits.h>
+#include <libtensor/gen_block_tensor/additive_gen_bto.h>
+
+namespace libtensor {
+
+
+/** \brief Copies a block tensor into a different block structure
+    \tparam N Tensor order.
+
+    The result has the same dimensions as the argument, but is split into
+    blocks differently. Each block of the result is assembled from windows
+    of the blocks of the argument it overlaps with, so blocks can be both
+    merged and split. This is used to bring tensors with many small blocks
+    to larger blocks before an expensive operation and back afterwards.
+
+    Only permutational symmetry (se_perm) is carried over to the result,
+    other symmetry elements depend on the block structure. Arguments with
+    other symmetry elements are rejected, see is_reblockable(). Dimensions
+    related by symmetry need to be split the same way in the result.
+
+    make_splits() offers a way of merging the blocks of a subspace until
+    they have at least a given length.
+
+    \ingroup libtensor_block_tensor_btod
+ **/
+template<size_t N>
+class btod_reblock :
+    public additive_gen_bto<N, btod_traits::bti_traits>,
+    public timings< btod_reblock<N> >,
+    public noncopyable {
+
+public:
+    static const char k_clazz[]; //!< Class name
+
+public:
+    typedef btod_traits::bti_traits bti_traits;
+
+private:
+    block_tensor_rd_i<N, double> &m_bta; //!< Argument
+    block_index_space<N> m_bisb; //!< Block index space of the result
+    dimensions<N> m_bidimsa; //!< Block index dimensions of the argument
+    dimensions<N> m_bidimsb; //!< Block index dimensions of the result
+    std::vector<size_t> m_bnda[N]; //!< Block boundaries of the argument
+    std::vector<size_t> m_bndb[N]; //!< Block boundaries of the result
+    symmetry<N, double> m_symb; //!< Symmetry of the result
+    assignment_schedule<N, double> m_sch; //!< Assignment schedule
+
+public:
+    /** \brief Initializes the operation
+        \param bta Argument.
+        \param bisb Block index space of the result.
+     **/
+    btod_reblock(block_tensor_rd_i<N, double> &bta,
+        const block_index_space<N> &bisb);
+
+    /** \brief Virtual destructor
+     **/
+    virtual ~btod_reblock() { }
+
+    //! \name Implementation of libtensor::direct_gen_bto<N, bti_traits>
+    //@{
+
+    virtual const block_index_space<N> &get_bis() const {
+        return m_bisb;
+    }
+
+    virtual const symmetry<N, double> &get_symmetry() const {
+        return m_symb;
+    }
+
+    virtual const assignment_schedule<N, double> &get_schedule() const {
+        return m_sch;
+    }
+
+    virtual void perform(gen_block_stream_i<N, bti_traits> &out);
+
+    //@}
+
+    //! \name Implementation of libtensor::additive_gen_bto<N, bti_traits>
+    //@{
+
+    virtual void perform(gen_block_tensor_i<N, bti_traits> &btb);
+
+    virtual void perform(gen_block_tensor_i<N, bti_traits> &btb,
+        const scalar_transf<double> &c);
+
+    virtual void compute_block(
+        bool zero,
+        const index<N> &ib,
+        const tensor_transf<N, double> &trb,
+        dense_tensor_wr_i<N, double> &blkb);
+
+    virtual void compute_block(
+        const index<N> &ib,
+        dense_tensor_wr_i<N, double> &blkb) {
+
+        compute_block(true, ib, tensor_transf<N, double>(), blkb);
+    }
+
+    //@}
+
+    /** \brief Computes any block of the result (canonical or not) into
+            the given block of the same dimensions (may be called
+            concurrently)
+     **/
+    void compute_block_untimed(const index<N> &ib,
+        dense_tensor_wr_i<N, double> &blkb);
+
+    /** \brief Returns true if the symmetry can be carried over to another
+            block structure
+     **/
+    static bool is_reblockable(const symmetry<N, double> &sym);
+
+    /** \brief Merges the blocks of a subspace until all of them are at
+            least the given length long, unless the whole subspace is
+            shorter
+        \param sp Split points of the subspace.
+        \param dim Length of the subspace.
+        \param len Target length of blocks.
+        \param[out] sp1 Split points of the merged subspace.
+        \return True if any blocks were merged.
+     **/
+    static bool make_splits(const split_points &sp, size_t dim, size_t len,
+        split_points &sp1);
+
+private:
+    void make_schedule();
+    void get_overlap(const index<N> &ib, index<N> &ia1,
+        index<N> &ia2) const;
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BTOD_REBLOCK_H
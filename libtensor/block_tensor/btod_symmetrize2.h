@@ -29,6 +29,7 @@ public:
 
 private:
     gen_bto_symmetrize2< N, btod_traits, btod_symmetrize2<N> > m_gbto;
+    bool m_blockwise; //!< Compute each block of the result at once
 
 public:
     //!    \name Construction and destruction
@@ -43,7 +44,8 @@ public:
     btod_symmetrize2(additive_gen_bto<N, bti_traits> &op,
         size_t i1, size_t i2, bool symm) :
 
-        m_gbto(op, permutation<N>().permute(i1, i2), symm)
+        m_gbto(op, permutation<N>().permute(i1, i2), symm),
+        m_blockwise(false)
     { }
 
     /** \brief Initializes the operation using a unitary permutation (P = P^-1)
@@ -54,7 +56,24 @@ public:
     btod_symmetrize2(additive_gen_bto<N, bti_traits> &op,
         const permutation<N> &perm, bool symm) :
 
-        m_gbto(op, perm, symm)
+        m_gbto(op, perm, symm), m_blockwise(false)
+    { }
+
+    /** \brief Initializes the operation using a unitary permutation (P = P^-1)
+        \param op Symmetrized operation.
+        \param perm Unitary permutation.
+        \param symm True for symmetric, false for anti-symmetric.
+        \param blockwise Compute each canonical block of the result at once
+            from the blocks of op instead of streaming all the blocks of op.
+
+        The blockwise evaluation suits operations that compute individual
+        blocks efficiently, such as contractions. It yields every block of
+        the result once and does not accumulate contributions in the output.
+     **/
+    btod_symmetrize2(additive_gen_bto<N, bti_traits> &op,
+        const permutation<N> &perm, bool symm, bool blockwise) :
+
+        m_gbto(op, perm, symm), m_blockwise(blockwise)
     { }
 
     /** \brief Virtual destructor
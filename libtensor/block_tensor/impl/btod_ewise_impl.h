@@ -0,0 +1,493 @@
+#ifndef LIBTENSOR_BTOD_EWISE_IMPL_H
+#define LIBTENSOR_BTOD_EWISE_IMPL_H
+
+#include <algorithm>
+#include <memory>
+#include <libutil/thread_pool/thread_pool.h>
+#include <libtensor/core/abs_index.h>
+#include <libtensor/core/bad_block_index_space.h>
+#include <libtensor/core/block_index_space_product_builder.h>
+#include <libtensor/core/orbit.h>
+#include <libtensor/core/orbit_list.h>
+#include <libtensor/dense_tensor/dense_tensor.h>
+#include <libtensor/dense_tensor/dense_tensor_ctrl.h>
+#include <libtensor/dense_tensor/tod_copy.h>
+#include <libtensor/dense_tensor/tod_set.h>
+#include <libtensor/symmetry/so_dirprod.h>
+#include <libtensor/symmetry/so_dirsum.h>
+#include <libtensor/symmetry/so_merge.h>
+#include <libtensor/symmetry/so_permute.h>
+#include <libtensor/gen_block_tensor/addition_schedule.h>
+#include <libtensor/gen_block_tensor/gen_block_tensor_ctrl.h>
+#include <libtensor/gen_block_tensor/gen_bto_aux_add.h>
+#include <libtensor/gen_block_tensor/gen_bto_aux_copy.h>
+#include "../btod_ewise.h"
+
+namespace libtensor {
+
+
+template<size_t N>
+const char btod_ewise<N>::k_clazz[] = "btod_ewise<N>";
+
+
+template<size_t N>
+class btod_ewise_task : public libutil::task_i {
+public:
+    typedef btod_traits::bti_traits bti_traits;
+
+private:
+    btod_ewise<N> &m_bto;
+    index<N> m_idx;
+    gen_block_stream_i<N, bti_traits> &m_out;
+
+public:
+    btod_ewise_task(btod_ewise<N> &bto, const index<N> &idx,
+        gen_block_stream_i<N, bti_traits> &out) :
+        m_bto(bto), m_idx(idx), m_out(out)
+    { }
+
+    virtual ~btod_ewise_task() { }
+    virtual unsigned long get_cost() const { return 0; }
+    virtual void perform();
+
+};
+
+
+template<size_t N>
+class btod_ewise_task_iterator : public libutil::task_iterator_i {
+public:
+    typedef btod_traits::bti_traits bti_traits;
+
+private:
+    btod_ewise<N> &m_bto;
+    gen_block_stream_i<N, bti_traits> &m_out;
+    dimensions<N> m_bidims;
+    const assignment_schedule<N, double> &m_sch;
+    typename assignment_schedule<N, double>::iterator m_i;
+
+public:
+    btod_ewise_task_iterator(btod_ewise<N> &bto,
+        gen_block_stream_i<N, bti_traits> &out) :
+        m_bto(bto), m_out(out),
+        m_bidims(m_bto.get_bis().get_block_index_dims()),
+        m_sch(m_bto.get_schedule()), m_i(m_sch.begin())
+    { }
+
+    virtual bool has_more() const {
+        return m_i != m_sch.end();
+    }
+
+    virtual libutil::task_i *get_next() {
+        index<N> idx;
+        abs_index<N>::get_index(m_sch.get_abs_index(m_i), m_bidims, idx);
+        ++m_i;
+        return new btod_ewise_task<N>(m_bto, idx, m_out);
+    }
+
+};
+
+
+template<size_t N>
+class btod_ewise_task_observer : public libutil::task_observer_i {
+public:
+    virtual void notify_start_task(libutil::task_i *t) { }
+    virtual void notify_finish_task(libutil::task_i *t) { delete t; }
+
+};
+
+
+template<size_t N>
+btod_ewise<N>::btod_ewise(block_tensor_rd_i<N, double> &bt,
+    const tensor_transf<N, double> &tr) :
+
+    m_bis(block_index_space<N>(bt.get_bis()).permute(tr.get_perm())),
+    m_bidims(m_bis.get_block_index_dims()), m_depth(0), m_dirty_sch(true),
+    m_sch(0) {
+
+    push(bt, tr);
+}
+
+
+template<size_t N>
+btod_ewise<N>::~btod_ewise() {
+
+    delete m_sch;
+    for(size_t i = 0; i < m_syms.size(); i++) delete m_syms[i];
+}
+
+
+template<size_t N>
+void btod_ewise<N>::push(block_tensor_rd_i<N, double> &bt,
+    const tensor_transf<N, double> &tr) {
+
+    static const char method[] = "push(block_tensor_rd_i<N, double>&, "
+        "const tensor_transf<N, double>&)";
+
+    block_index_space<N> bis1(bt.get_bis());
+    bis1.permute(tr.get_perm());
+    block_index_space<N> bis2(m_bis), bis3(bis1);
+    bis2.match_splits();
+    bis3.match_splits();
+    if(!bis2.equals(bis3)) {
+        throw bad_block_index_space(g_ns, k_clazz, method, __FILE__, __LINE__,
+            "bt");
+    }
+
+    std::auto_ptr< symmetry<N, double> > sym(new symmetry<N, double>(bis1));
+    {
+        gen_block_tensor_rd_ctrl<N, bti_traits> ctrl(bt);
+        so_permute<N, double>(ctrl.req_const_symmetry(), tr.get_perm()).
+            perform(*sym);
+    }
+
+    m_args.push_back(arg_type(bt, tr));
+    m_prog.push_back(instr_type(k_push, m_args.size() - 1));
+    m_syms.push_back(sym.release());
+    m_depth = std::max(m_depth, m_syms.size());
+    m_dirty_sch = true;
+}
+
+
+template<size_t N>
+void btod_ewise<N>::add() {
+
+    combine(k_add);
+}
+
+
+template<size_t N>
+void btod_ewise<N>::mult() {
+
+    combine(k_mult);
+}
+
+
+template<size_t N>
+void btod_ewise<N>::div() {
+
+    combine(k_div);
+}
+
+
+template<size_t N>
+const symmetry<N, double> &btod_ewise<N>::get_symmetry() const {
+
+    static const char method[] = "get_symmetry()";
+
+    if(m_syms.size() != 1) {
+        throw bad_parameter(g_ns, k_clazz, method, __FILE__, __LINE__,
+            "Incomplete expression.");
+    }
+    return *m_syms[0];
+}
+
+
+template<size_t N>
+const assignment_schedule<N, double> &btod_ewise<N>::get_schedule() const {
+
+    if(m_sch == 0 || m_dirty_sch) make_schedule();
+    return *m_sch;
+}
+
+
+template<size_t N>
+void btod_ewise<N>::perform(gen_block_stream_i<N, bti_traits> &out) {
+
+    btod_ewise::start_timer();
+
+    try {
+
+        btod_ewise_task_iterator<N> ti(*this, out);
+        btod_ewise_task_observer<N> to;
+        libutil::thread_pool::submit(ti, to);
+
+    } catch(...) {
+        btod_ewise::stop_timer();
+        throw;
+    }
+
+    btod_ewise::stop_timer();
+}
+
+
+template<size_t N>
+void btod_ewise<N>::perform(gen_block_tensor_i<N, bti_traits> &btb) {
+
+    gen_bto_aux_copy<N, btod_traits> out(get_symmetry(), btb);
+    out.open();
+    perform(out);
+    out.close();
+}
+
+
+template<size_t N>
+void btod_ewise<N>::perform(gen_block_tensor_i<N, bti_traits> &btb,
+    const scalar_transf<double> &c) {
+
+    gen_block_tensor_rd_ctrl<N, bti_traits> cb(btb);
+    std::vector<size_t> nzblkb;
+    cb.req_nonzero_blocks(nzblkb);
+    addition_schedule<N, btod_traits> asch(get_symmetry(),
+        cb.req_const_symmetry());
+    asch.build(get_schedule(), nzblkb);
+
+    gen_bto_aux_add<N, btod_traits> out(get_symmetry(), asch, btb, c);
+    out.open();
+    perform(out);
+    out.close();
+}
+
+
+template<size_t N>
+void btod_ewise<N>::compute_block(
+    bool zero,
+    const index<N> &ib,
+    const tensor_transf<N, double> &trb,
+    dense_tensor_wr_i<N, double> &blkb) {
+
+    btod_ewise::start_timer("compute_block");
+
+    try {
+
+        if(zero && trb.is_identity()) {
+            compute_block_untimed(ib, blkb);
+        } else {
+            dense_tensor< N, double, allocator<double> > blk(
+                m_bis.get_block_dims(ib));
+            compute_block_untimed(ib, blk);
+            tod_copy<N>(blk, trb).perform(zero, blkb);
+        }
+
+    } catch(...) {
+        btod_ewise::stop_timer("compute_block");
+        throw;
+    }
+
+    btod_ewise::stop_timer("compute_block");
+}
+
+
+template<size_t N>
+void btod_ewise<N>::compute_block_untimed(const index<N> &ib,
+    dense_tensor_wr_i<N, double> &blkb) {
+
+    static const char method[] = "compute_block_untimed()";
+
+    typedef dense_tensor< N, double, allocator<double> > temp_block_type;
+
+    //  The bottom of the stack is the output block, the other entries are
+    //  temporary blocks of the same dimensions
+
+    dimensions<N> dims(m_bis.get_block_dims(ib));
+    size_t sz = dims.get_size();
+    std::vector<temp_block_type*> tmp;
+    std::vector<bool> nz;
+    nz.reserve(m_depth);
+
+    try {
+
+        for(size_t ip = 0; ip < m_prog.size(); ip++) {
+
+            const instr_type &instr = m_prog[ip];
+            size_t s = nz.size();
+
+            if(instr.op == k_push) {
+                if(s > tmp.size()) tmp.push_back(new temp_block_type(dims));
+                dense_tensor_wr_i<N, double> &blk =
+                    s == 0 ? blkb : *tmp[s - 1];
+                nz.push_back(fetch_arg(instr.arg, ib, blk));
+                continue;
+            }
+
+            bool nza = nz[s - 2], nzb = nz[s - 1];
+            nz.pop_back();
+
+            if(instr.op == k_div && !nzb) {
+                throw bad_parameter(g_ns, k_clazz, method,
+                    __FILE__, __LINE__, "Zero block in divisor.");
+            }
+            if(instr.op == k_add && !nzb) continue;
+            if(instr.op == k_mult && !(nza && nzb)) {
+                nz[s - 2] = false;
+                continue;
+            }
+            if(instr.op == k_div && !nza) continue;
+
+            dense_tensor_wr_i<N, double> &blka = s == 2 ? blkb : *tmp[s - 3];
+            dense_tensor_wr_ctrl<N, double> ca(blka);
+            dense_tensor_rd_ctrl<N, double> cb(*tmp[s - 2]);
+            double *pa = ca.req_dataptr();
+            const double *pb = cb.req_const_dataptr();
+            if(instr.op == k_add) {
+                if(nza) for(size_t i = 0; i < sz; i++) pa[i] += pb[i];
+                else std::copy(pb, pb + sz, pa);
+            } else if(instr.op == k_mult) {
+                for(size_t i = 0; i < sz; i++) pa[i] *= pb[i];
+            } else {
+                for(size_t i = 0; i < sz; i++) pa[i] /= pb[i];
+            }
+            cb.ret_const_dataptr(pb);
+            ca.ret_dataptr(pa);
+            nz[s - 2] = true;
+        }
+
+        if(!nz[0]) tod_set<N>().perform(true, blkb);
+
+    } catch(...) {
+        for(size_t i = 0; i < tmp.size(); i++) delete tmp[i];
+        throw;
+    }
+
+    for(size_t i = 0; i < tmp.size(); i++) delete tmp[i];
+}
+
+
+template<size_t N>
+void btod_ewise<N>::combine(int op) {
+
+    static const char method[] = "combine(int)";
+
+    if(m_syms.size() < 2) {
+        throw bad_parameter(g_ns, k_clazz, method, __FILE__, __LINE__,
+            "Stack underflow.");
+    }
+
+    //  Symmetry of the sum as in btod_sum, of the product or quotient as
+    //  in btod_mult
+
+    std::auto_ptr< symmetry<N, double> > symb(m_syms.back());
+    m_syms.pop_back();
+    symmetry<N, double> &syma = *m_syms.back();
+
+    permutation<N + N> perm0;
+    block_index_space_product_builder<N, N> bbx(m_bis, m_bis, perm0);
+    symmetry<N + N, double> symx(bbx.get_bis());
+    if(op == k_add) {
+        so_dirsum<N, N, double>(syma, *symb, perm0).perform(symx);
+    } else {
+        so_dirprod<N, N, double>(syma, *symb, perm0).perform(symx);
+    }
+    mask<N + N> msk;
+    sequence<N + N, size_t> seq;
+    for(size_t i = 0; i < N; i++) {
+        msk[i] = msk[i + N] = true;
+        seq[i] = seq[i + N] = i;
+    }
+    std::auto_ptr< symmetry<N, double> > symc(new symmetry<N, double>(m_bis));
+    so_merge<N + N, N, double>(symx, msk, seq).perform(*symc);
+
+    delete m_syms.back();
+    m_syms.back() = symc.release();
+    m_prog.push_back(instr_type(op, 0));
+    m_dirty_sch = true;
+}
+
+
+template<size_t N>
+void btod_ewise<N>::make_schedule() const {
+
+    static const char method[] = "make_schedule()";
+
+    const symmetry<N, double> &sym = get_symmetry();
+
+    delete m_sch;
+    m_sch = new assignment_schedule<N, double>(m_bidims);
+
+    //  Non-zero arguments are found for each canonical block of the result
+    //  and combined according to the expression
+
+    std::vector<bool> nz;
+    nz.reserve(m_depth);
+
+    orbit_list<N, double> ol(sym);
+    for(typename orbit_list<N, double>::iterator iol = ol.begin();
+        iol != ol.end(); ++iol) {
+
+        index<N> ib;
+        ol.get_index(iol, ib);
+
+        nz.clear();
+        for(size_t ip = 0; ip < m_prog.size(); ip++) {
+
+            const instr_type &instr = m_prog[ip];
+
+            if(instr.op == k_push) {
+                const arg_type &arg = m_args[instr.arg];
+                gen_block_tensor_rd_ctrl<N, bti_traits> ctrl(*arg.bt);
+                index<N> ia(ib);
+                ia.permute(permutation<N>(arg.tr.get_perm(), true));
+                orbit<N, double> oa(ctrl.req_const_symmetry(), ia);
+                bool nza = oa.is_allowed();
+                if(nza) {
+                    abs_index<N> aci(oa.get_acindex(),
+                        arg.bt->get_bis().get_block_index_dims());
+                    nza = !ctrl.req_is_zero_block(aci.get_index());
+                }
+                nz.push_back(nza);
+                continue;
+            }
+
+            bool nzb = nz.back();
+            nz.pop_back();
+            if(instr.op == k_add) {
+                nz.back() = nz.back() || nzb;
+            } else if(instr.op == k_mult) {
+                nz.back() = nz.back() && nzb;
+            } else if(!nzb) {
+                throw bad_parameter(g_ns, k_clazz, method,
+                    __FILE__, __LINE__, "Zero block in divisor.");
+            }
+        }
+
+        if(nz.back()) m_sch->insert(ib);
+    }
+
+    m_dirty_sch = false;
+}
+
+
+template<size_t N>
+bool btod_ewise<N>::fetch_arg(size_t iarg, const index<N> &ib,
+    dense_tensor_wr_i<N, double> &blk) {
+
+    const arg_type &arg = m_args[iarg];
+    gen_block_tensor_rd_ctrl<N, bti_traits> ctrl(*arg.bt);
+
+    index<N> ia(ib);
+    ia.permute(permutation<N>(arg.tr.get_perm(), true));
+    orbit<N, double> oa(ctrl.req_const_symmetry(), ia);
+    if(!oa.is_allowed()) return false;
+
+    abs_index<N> aci(oa.get_acindex(),
+        arg.bt->get_bis().get_block_index_dims());
+    if(ctrl.req_is_zero_block(aci.get_index())) return false;
+
+    tensor_transf<N, double> tra(oa.get_transf(ia));
+    tra.transform(arg.tr);
+
+    dense_tensor_rd_i<N, double> &blka =
+        ctrl.req_const_block(aci.get_index());
+    try {
+        tod_copy<N>(blka, tra).perform(true, blk);
+    } catch(...) {
+        ctrl.ret_const_block(aci.get_index());
+        throw;
+    }
+    ctrl.ret_const_block(aci.get_index());
+    return true;
+}
+
+
+template<size_t N>
+void btod_ewise_task<N>::perform() {
+
+    dense_tensor< N, double, allocator<double> > blk(
+        m_bto.get_bis().get_block_dims(m_idx));
+    m_bto.compute_block_untimed(m_idx, blk);
+    m_out.put(m_idx, blk, tensor_transf<N, double>());
+}
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BTOD_EWISE_IMPL_H
@@ -0,0 +1,379 @@
+#ifndef LIBTENSOR_BTOD_REBLOCK_IMPL_H
+#define LIBTENSOR_BTOD_REBLOCK_IMPL_H
+
+#include <algorithm>
+#include <libutil/thread_pool/thread_pool.h>
+#include <libtensor/core/abs_index.h>
+#include <libtensor/core/bad_block_index_space.h>
+#include <libtensor/core/orbit.h>
+#include <libtensor/core/orbit_list.h>
+#include <libtensor/dense_tensor/dense_tensor.h>
+#include <libtensor/dense_tensor/tod_copy.h>
+#include <libtensor/dense_tensor/tod_copy_wnd.h>
+#include <libtensor/dense_tensor/tod_set.h>
+#include <libtensor/symmetry/se_perm.h>
+#include <libtensor/symmetry/symmetry_element_set_adapter.h>
+#include <libtensor/gen_block_tensor/addition_schedule.h>
+#include <libtensor/gen_block_tensor/gen_block_tensor_ctrl.h>
+#include <libtensor/gen_block_tensor/gen_bto_aux_add.h>
+#include <libtensor/gen_block_tensor/gen_bto_aux_copy.h>
+#include "../btod_reblock.h"
+
+namespace libtensor {
+
+
+template<size_t N>
+const char btod_reblock<N>::k_clazz[] = "btod_reblock<N>";
+
+
+template<size_t N>
+class btod_reblock_task : public libutil::task_i {
+public:
+    typedef btod_traits::bti_traits bti_traits;
+
+private:
+    btod_reblock<N> &m_bto;
+    index<N> m_idx;
+    gen_block_stream_i<N, bti_traits> &m_out;
+
+public:
+    btod_reblock_task(btod_reblock<N> &bto, const index<N> &idx,
+        gen_block_stream_i<N, bti_traits> &out) :
+        m_bto(bto), m_idx(idx), m_out(out)
+    { }
+
+    virtual ~btod_reblock_task() { }
+    virtual unsigned long get_cost() const { return 0; }
+    virtual void perform();
+
+};
+
+
+template<size_t N>
+class btod_reblock_task_iterator : public libutil::task_iterator_i {
+public:
+    typedef btod_traits::bti_traits bti_traits;
+
+private:
+    btod_reblock<N> &m_bto;
+    gen_block_stream_i<N, bti_traits> &m_out;
+    dimensions<N> m_bidims;
+    const assignment_schedule<N, double> &m_sch;
+    typename assignment_schedule<N, double>::iterator m_i;
+
+public:
+    btod_reblock_task_iterator(btod_reblock<N> &bto,
+        gen_block_stream_i<N, bti_traits> &out) :
+        m_bto(bto), m_out(out),
+        m_bidims(m_bto.get_bis().get_block_index_dims()),
+        m_sch(m_bto.get_schedule()), m_i(m_sch.begin())
+    { }
+
+    virtual bool has_more() const {
+        return m_i != m_sch.end();
+    }
+
+    virtual libutil::task_i *get_next() {
+        index<N> idx;
+        abs_index<N>::get_index(m_sch.get_abs_index(m_i), m_bidims, idx);
+        ++m_i;
+        return new btod_reblock_task<N>(m_bto, idx, m_out);
+    }
+
+};
+
+
+template<size_t N>
+class btod_reblock_task_observer : public libutil::task_observer_i {
+public:
+    virtual void notify_start_task(libutil::task_i *t) { }
+    virtual void notify_finish_task(libutil::task_i *t) { delete t; }
+
+};
+
+
+template<size_t N>
+btod_reblock<N>::btod_reblock(block_tensor_rd_i<N, double> &bta,
+    const block_index_space<N> &bisb) :
+
+    m_bta(bta), m_bisb(bisb),
+    m_bidimsa(m_bta.get_bis().get_block_index_dims()),
+    m_bidimsb(m_bisb.get_block_index_dims()), m_symb(m_bisb),
+    m_sch(m_bidimsb) {
+
+    static const char method[] = "btod_reblock(block_tensor_rd_i<N, double>&, "
+        "const block_index_space<N>&)";
+
+    const block_index_space<N> &bisa = m_bta.get_bis();
+    if(!bisa.get_dims().equals(m_bisb.get_dims())) {
+        throw bad_block_index_space(g_ns, k_clazz, method,
+            __FILE__, __LINE__, "bisb");
+    }
+
+    for(size_t i = 0; i < N; i++) {
+        const split_points &spa = bisa.get_splits(bisa.get_type(i));
+        const split_points &spb = m_bisb.get_splits(m_bisb.get_type(i));
+        m_bnda[i].push_back(0);
+        for(size_t j = 0; j < spa.get_num_points(); j++) {
+            m_bnda[i].push_back(spa[j]);
+        }
+        m_bnda[i].push_back(bisa.get_dims().get_dim(i));
+        m_bndb[i].push_back(0);
+        for(size_t j = 0; j < spb.get_num_points(); j++) {
+            m_bndb[i].push_back(spb[j]);
+        }
+        m_bndb[i].push_back(m_bisb.get_dims().get_dim(i));
+    }
+
+    gen_block_tensor_rd_ctrl<N, bti_traits> ca(m_bta);
+    const symmetry<N, double> &syma = ca.req_const_symmetry();
+    if(!is_reblockable(syma)) {
+        throw bad_parameter(g_ns, k_clazz, method, __FILE__, __LINE__,
+            "Symmetry of bta cannot be reblocked.");
+    }
+    for(typename symmetry<N, double>::iterator is = syma.begin();
+        is != syma.end(); ++is) {
+
+        symmetry_element_set_adapter< N, double, se_perm<N, double> >
+            adapter(syma.get_subset(is));
+        for(typename symmetry_element_set<N, double>::const_iterator ie =
+            adapter.begin(); ie != adapter.end(); ++ie) {
+            m_symb.insert(adapter.get_elem(ie));
+        }
+    }
+
+    make_schedule();
+}
+
+
+template<size_t N>
+void btod_reblock<N>::perform(gen_block_stream_i<N, bti_traits> &out) {
+
+    btod_reblock::start_timer();
+
+    try {
+
+        btod_reblock_task_iterator<N> ti(*this, out);
+        btod_reblock_task_observer<N> to;
+        libutil::thread_pool::submit(ti, to);
+
+    } catch(...) {
+        btod_reblock::stop_timer();
+        throw;
+    }
+
+    btod_reblock::stop_timer();
+}
+
+
+template<size_t N>
+void btod_reblock<N>::perform(gen_block_tensor_i<N, bti_traits> &btb) {
+
+    gen_bto_aux_copy<N, btod_traits> out(m_symb, btb);
+    out.open();
+    perform(out);
+    out.close();
+}
+
+
+template<size_t N>
+void btod_reblock<N>::perform(gen_block_tensor_i<N, bti_traits> &btb,
+    const scalar_transf<double> &c) {
+
+    gen_block_tensor_rd_ctrl<N, bti_traits> cb(btb);
+    std::vector<size_t> nzblkb;
+    cb.req_nonzero_blocks(nzblkb);
+    addition_schedule<N, btod_traits> asch(m_symb, cb.req_const_symmetry());
+    asch.build(m_sch, nzblkb);
+
+    gen_bto_aux_add<N, btod_traits> out(m_symb, asch, btb, c);
+    out.open();
+    perform(out);
+    out.close();
+}
+
+
+template<size_t N>
+void btod_reblock<N>::compute_block(
+    bool zero,
+    const index<N> &ib,
+    const tensor_transf<N, double> &trb,
+    dense_tensor_wr_i<N, double> &blkb) {
+
+    btod_reblock::start_timer("compute_block");
+
+    try {
+
+        if(zero && trb.is_identity()) {
+            compute_block_untimed(ib, blkb);
+        } else {
+            dense_tensor< N, double, allocator<double> > blk(
+                m_bisb.get_block_dims(ib));
+            compute_block_untimed(ib, blk);
+            tod_copy<N>(blk, trb).perform(zero, blkb);
+        }
+
+    } catch(...) {
+        btod_reblock::stop_timer("compute_block");
+        throw;
+    }
+
+    btod_reblock::stop_timer("compute_block");
+}
+
+
+template<size_t N>
+void btod_reblock<N>::compute_block_untimed(const index<N> &ib,
+    dense_tensor_wr_i<N, double> &blkb) {
+
+    typedef dense_tensor< N, double, allocator<double> > temp_block_type;
+
+    gen_block_tensor_rd_ctrl<N, bti_traits> ca(m_bta);
+    const symmetry<N, double> &syma = ca.req_const_symmetry();
+
+    tod_set<N>().perform(true, blkb);
+
+    index<N> ia1, ia2, io1, io2;
+    get_overlap(ib, ia1, ia2);
+    for(size_t i = 0; i < N; i++) io2[i] = ia2[i] - ia1[i];
+    abs_index<N> aio(dimensions<N>(index_range<N>(io1, io2)));
+
+    //  Copy the overlapping window of each argument block
+
+    do {
+
+        index<N> ia;
+        for(size_t i = 0; i < N; i++) ia[i] = ia1[i] + aio.get_index()[i];
+
+        orbit<N, double> oa(syma, ia);
+        if(!oa.is_allowed()) continue;
+        abs_index<N> aci(oa.get_acindex(), m_bidimsa);
+        if(ca.req_is_zero_block(aci.get_index())) continue;
+
+        index<N> wa1, wa2, wb1, wb2;
+        for(size_t i = 0; i < N; i++) {
+            size_t alo = m_bnda[i][ia[i]], blo = m_bndb[i][ib[i]];
+            size_t lo = std::max(alo, blo);
+            size_t hi = std::min(m_bnda[i][ia[i] + 1], m_bndb[i][ib[i] + 1]);
+            wa1[i] = lo - alo; wa2[i] = hi - alo - 1;
+            wb1[i] = lo - blo; wb2[i] = hi - blo - 1;
+        }
+        index_range<N> ira(wa1, wa2), irb(wb1, wb2);
+
+        const tensor_transf<N, double> &tra = oa.get_transf(ia);
+        dense_tensor_rd_i<N, double> &blka =
+            ca.req_const_block(aci.get_index());
+        try {
+            if(tra.is_identity()) {
+                tod_copy_wnd<N>(blka, ira).perform(blkb, irb);
+            } else {
+                temp_block_type tblk(m_bta.get_bis().get_block_dims(ia));
+                tod_copy<N>(blka, tra).perform(true, tblk);
+                tod_copy_wnd<N>(tblk, ira).perform(blkb, irb);
+            }
+        } catch(...) {
+            ca.ret_const_block(aci.get_index());
+            throw;
+        }
+        ca.ret_const_block(aci.get_index());
+
+    } while(aio.inc());
+}
+
+
+template<size_t N>
+bool btod_reblock<N>::is_reblockable(const symmetry<N, double> &sym) {
+
+    for(typename symmetry<N, double>::iterator is = sym.begin();
+        is != sym.end(); ++is) {
+        if(sym.get_subset(is).get_id() != se_perm<N, double>::k_sym_type) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+template<size_t N>
+bool btod_reblock<N>::make_splits(const split_points &sp, size_t dim,
+    size_t len, split_points &sp1) {
+
+    //  Keep the split points that end a block of at least len elements,
+    //  a short last block is merged into the previous one
+
+    std::vector<size_t> pts;
+    size_t last = 0;
+    for(size_t i = 0; i < sp.get_num_points(); i++) {
+        if(sp[i] - last < len) continue;
+        pts.push_back(sp[i]);
+        last = sp[i];
+    }
+    if(!pts.empty() && dim - last < len) pts.pop_back();
+
+    for(size_t i = 0; i < pts.size(); i++) sp1.add(pts[i]);
+    return pts.size() < sp.get_num_points();
+}
+
+
+template<size_t N>
+void btod_reblock<N>::make_schedule() {
+
+    gen_block_tensor_rd_ctrl<N, bti_traits> ca(m_bta);
+    const symmetry<N, double> &syma = ca.req_const_symmetry();
+
+    //  A block of the result is non-zero if any of the blocks of the
+    //  argument it overlaps with is non-zero
+
+    orbit_list<N, double> ol(m_symb);
+    for(typename orbit_list<N, double>::iterator iol = ol.begin();
+        iol != ol.end(); ++iol) {
+
+        index<N> ib, ia1, ia2, io1, io2;
+        ol.get_index(iol, ib);
+        get_overlap(ib, ia1, ia2);
+        for(size_t i = 0; i < N; i++) io2[i] = ia2[i] - ia1[i];
+        abs_index<N> aio(dimensions<N>(index_range<N>(io1, io2)));
+
+        bool nz = false;
+        do {
+            index<N> ia;
+            for(size_t i = 0; i < N; i++) ia[i] = ia1[i] + aio.get_index()[i];
+            orbit<N, double> oa(syma, ia);
+            if(!oa.is_allowed()) continue;
+            abs_index<N> aci(oa.get_acindex(), m_bidimsa);
+            nz = !ca.req_is_zero_block(aci.get_index());
+        } while(!nz && aio.inc());
+
+        if(nz) m_sch.insert(ib);
+    }
+}
+
+
+template<size_t N>
+void btod_reblock<N>::get_overlap(const index<N> &ib, index<N> &ia1,
+    index<N> &ia2) const {
+
+    for(size_t i = 0; i < N; i++) {
+        const std::vector<size_t> &bnda = m_bnda[i];
+        size_t lo = m_bndb[i][ib[i]], hi = m_bndb[i][ib[i] + 1];
+        ia1[i] = std::upper_bound(bnda.begin(), bnda.end(), lo) -
+            bnda.begin() - 1;
+        ia2[i] = std::lower_bound(bnda.begin(), bnda.end(), hi) -
+            bnda.begin() - 1;
+    }
+}
+
+
+template<size_t N>
+void btod_reblock_task<N>::perform() {
+
+    dense_tensor< N, double, allocator<double> > blk(
+        m_bto.get_bis().get_block_dims(m_idx));
+    m_bto.compute_block_untimed(m_idx, blk);
+    m_out.put(m_idx, blk, tensor_transf<N, double>());
+}
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BTOD_REBLOCK_IMPL_H
@@ -19,7 +19,8 @@ template<size_t N>
 void btod_symmetrize2<N>::perform(
     gen_block_stream_i<N, bti_traits> &out) {
 
-    m_gbto.perform(out);
+    if(m_blockwise) m_gbto.perform_blockwise(out);
+    else m_gbto.perform(out);
 }
 
 
@@ -3,6 +3,7 @@
 
 #include <cstdlib> // for size_t
 #include <string>
+#include <libutil/timings/perf_counters.h>
 
 namespace libtensor {
 
@@ -95,6 +96,7 @@ public:
         \return Virtual memory pointer.
      **/
     static pointer_type allocate(size_t sz) {
+        libutil::perf_counters::add_allocated(sz * sizeof(T));
         return m_aimpl->allocate(sz);
     }
 
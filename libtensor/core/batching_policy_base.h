@@ -18,6 +18,8 @@ class batching_policy_base : public libutil::singleton<batching_policy_base> {
 
 private:
     size_t m_batchsz; //!< Batch size
+    size_t m_batchmem; //!< Memory budget for one batch (bytes)
+    bool m_unfold; //!< Whether to unfold the symmetry of batches
 
 protected:
     batching_policy_base();
@@ -25,6 +27,26 @@ protected:
 public:
     static void set_batch_size(size_t batchsz);
     static size_t get_batch_size();
+
+    /** \brief Sets the memory budget in bytes available to one batch
+
+        If the budget is zero (default), batching policies fall back to
+        the block count given by set_batch_size().
+     **/
+    static void set_batch_memory(size_t batchmem);
+    static size_t get_batch_memory();
+
+    /** \brief Sets whether the batches of the arguments of contractions
+            are unfolded
+
+        If true (default), all the blocks of the arguments needed by a batch
+        are made explicit in temporary copies before the blocks are
+        contracted. If false, only the canonical blocks are kept, and the
+        symmetry transformations are applied in the contractions of blocks.
+        This saves memory for arguments with high symmetry.
+     **/
+    static void set_unfold_symmetry(bool unfold);
+    static bool get_unfold_symmetry();
 };
 
 
@@ -2,6 +2,8 @@
 #define LIBTENSOR_ORBIT_LIST_IMPL_H
 
 #include <cstring>
+#include <limits>
+#include <sstream>
 #include <libutil/threads/tls.h>
 #include <libtensor/core/abs_index.h>
 #include "../orbit_list.h"
@@ -49,7 +51,26 @@ orbit_list<N, T>::orbit_list(const symmetry<N, T> &sym) :
 
     orbit_list::start_timer();
 
-    index<N> idx;
+    std::string key;
+    bool cache = orbit_list_cache::get_max_memory() > 0 &&
+        make_key(sym, key);
+    if(cache) m_orb = orbit_list_cache::lookup(key);
+
+    if(!m_orb) {
+        std::shared_ptr< std::vector<size_t> > orb(new std::vector<size_t>);
+        build(sym, *orb);
+        m_orb = orb;
+        if(cache) orbit_list_cache::insert(key, m_orb);
+    }
+
+    orbit_list::stop_timer();
+}
+
+
+template<size_t N, typename T>
+void orbit_list<N, T>::build(const symmetry<N, T> &sym,
+    std::vector<size_t> &orb) {
+
     size_t aidx = 0, n = m_dims.get_size();
 
     std::vector<char> &chk = orbit_list_buffer::get_v();
@@ -62,10 +83,8 @@ orbit_list<N, T>::orbit_list(const symmetry<N, T> &sym) :
         const char *p = (const char*)::memchr(p0 + aidx, 0, n - aidx);
         if(p == 0) break;
         aidx = p - p0;
-        if(mark_orbit(sym, aidx, chk)) m_orb.push_back(aidx);
+        if(mark_orbit(sym, aidx, chk)) orb.push_back(aidx);
     }
-
-    orbit_list::stop_timer();
 }
 
 
@@ -111,6 +130,36 @@ bool orbit_list<N, T>::mark_orbit(const symmetry<N, T> &sym, size_t aidx0,
 }
 
 
+template<size_t N, typename T>
+bool orbit_list<N, T>::make_key(const symmetry<N, T> &sym, std::string &key) {
+
+    const dimensions<N> &dims = sym.get_bis().get_block_index_dims();
+
+    std::ostringstream ss;
+    ss.precision(std::numeric_limits<double>::digits10 + 2);
+    ss << N << '[';
+    for(size_t i = 0; i < N; i++) ss << dims[i] << ',';
+    ss << ']';
+
+    for(typename symmetry<N, T>::iterator iset = sym.begin();
+        iset != sym.end(); ++iset) {
+
+        const symmetry_element_set<N, T> &eset = sym.get_subset(iset);
+        for(typename symmetry_element_set<N, T>::const_iterator ielem =
+            eset.begin(); ielem != eset.end(); ++ielem) {
+
+            const symmetry_element_i<N, T> &elem = eset.get_elem(ielem);
+            ss << elem.get_type() << '{';
+            if(!elem.get_key(ss)) return false;
+            ss << '}';
+        }
+    }
+
+    key = ss.str();
+    return true;
+}
+
+
 } // namespace libtensor
 
 #endif // LIBTENSOR_ORBIT_LIST_IMPL_H
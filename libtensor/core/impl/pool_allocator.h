@@ -0,0 +1,159 @@
+#ifndef LIBTENSOR_POOL_ALLOCATOR_H
+#define LIBTENSOR_POOL_ALLOCATOR_H
+
+#include <cstdlib> // for size_t
+
+namespace libtensor {
+
+
+/** \brief Thread-caching pool allocator
+    \tparam T Data type.
+
+    Blocks are grouped in size classes: multiples of 64 bytes up to 1 KiB
+    and four classes per power of two above that. Freed blocks are kept in
+    a free list of the calling thread and handed out again to requests of
+    the same class without any locking. Lists that grow beyond the limit
+    of the thread spill into a shared depot for the NUMA node the block
+    was first allocated on, from which threads running on that node refill.
+    Blocks larger than 2^k_max_shift bytes are not pooled.
+
+    All blocks are aligned to 64 bytes. Large blocks are obtained directly
+    from the operating system, so their pages are placed on the node of the
+    thread that first writes to them (first touch), which is normally the
+    worker that allocated the block. A block freed on a different node is
+    returned to the depot of its own node to preserve the placement.
+
+    The allocator keeps statistics: the number of bytes in live blocks,
+    its high-water mark, and the number of requests and pool hits for each
+    size class. The statistics can be read at any time without stopping
+    the threads.
+
+    Because there is no virtual memory involved here, the virtual and
+    physical pointers are identical. Selected at run time using
+    allocator<T>::init("pool").
+
+    \ingroup libtensor_core
+ **/
+template<typename T>
+class pool_allocator {
+public:
+    typedef T *pointer_type; //!< Pointer type
+
+    enum {
+        k_align = 64, //!< Alignment of blocks (bytes)
+        k_max_shift = 30, //!< Log2 of the largest pooled class (bytes)
+        k_nclasses = 16 + 4 * (k_max_shift - 10) //!< Number of size classes
+    };
+
+public:
+    static const pointer_type invalid_pointer; //!< Invalid pointer constant
+
+public:
+    /** \brief Initializes the allocator and resets the statistics
+     **/
+    static void init(const char *prefix = 0);
+
+    /** \brief Shuts down the allocator
+
+        Returns the blocks held in the free lists of all threads and in the
+        depots to the operating system. Must not be called while other
+        threads use the allocator.
+     **/
+    static void shutdown();
+
+    /** \brief Returns the real size of a block, in bytes, including alignment
+        \param sz Block size in units of T.
+     **/
+    static size_t get_block_size(size_t sz);
+
+    /** \brief Allocates a block of memory
+        \param sz Block size (in units of type T).
+        \return Pointer to the block of memory.
+     **/
+    static pointer_type allocate(size_t sz);
+
+    /** \brief Returns a block of memory previously allocated using
+            allocate() to the pool
+        \param p Pointer to the block of memory.
+     **/
+    static void deallocate(pointer_type p);
+
+    /** \brief Prefetches a block of memory (does nothing in this
+            implementation)
+     **/
+    static void prefetch(pointer_type p) { }
+
+    /** \brief Locks a block of memory in physical space for read-only
+            (does nothing in this implementation)
+     **/
+    static const T *lock_ro(pointer_type p) {
+        return p;
+    }
+
+    /** \brief Unlocks a block of memory previously locked by lock_ro()
+            (does nothing in this implementation)
+     **/
+    static void unlock_ro(pointer_type p) { }
+
+    /** \brief Locks a block of memory in physical space for read-write
+            (does nothing in this implementation)
+     **/
+    static T *lock_rw(pointer_type p) {
+        return p;
+    }
+
+    /** \brief Unlocks a block of memory previously locked by lock_rw()
+            (does nothing in this implementation)
+     **/
+    static void unlock_rw(pointer_type p) { }
+
+    /** \brief Sets a priority flag on a memory block (stub)
+     **/
+    static void set_priority(pointer_type p) { }
+
+    /** \brief Unsets a priority flag on a memory block (stub)
+     **/
+    static void unset_priority(pointer_type p) { }
+
+public:
+    /** \brief Returns the number of bytes in live blocks
+     **/
+    static size_t get_live_bytes();
+
+    /** \brief Returns the high-water mark of the bytes in live blocks
+     **/
+    static size_t get_peak_bytes();
+
+    /** \brief Returns the number of allocations of a size class
+        \param cls Size class.
+     **/
+    static size_t get_requests(size_t cls);
+
+    /** \brief Returns the number of allocations of a size class that were
+            served from the pool
+        \param cls Size class.
+     **/
+    static size_t get_hits(size_t cls);
+
+    /** \brief Returns the size class of a block (k_nclasses if the block
+            is not pooled)
+        \param sz Block size in bytes.
+     **/
+    static size_t get_class(size_t sz);
+
+    /** \brief Returns the size of blocks in a size class in bytes
+        \param cls Size class.
+     **/
+    static size_t get_class_size(size_t cls);
+
+};
+
+
+template<typename T>
+const typename pool_allocator<T>::pointer_type
+    pool_allocator<T>::invalid_pointer = 0;
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_POOL_ALLOCATOR_H
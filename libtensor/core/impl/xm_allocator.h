@@ -22,12 +22,41 @@ struct map_data {
 };
 typedef std::map<uintptr_t, map_data> map_type;
 
+/** \brief Part of the table of allocated blocks with its own lock
+ **/
+struct map_shard {
+    libutil::mutex lock;
+    map_type map;
+};
+
+/** \brief Global state of the libxm allocator
+
+    The table of allocated blocks is split into shards selected by a hash
+    of the block pointer, so that threads locking different blocks do not
+    serialize on one mutex. g_lock only serializes calls to libxm that
+    change the allocation state.
+ **/
 class alloc_data : public libutil::singleton<alloc_data> {
     friend class libutil::singleton<alloc_data>;
+public:
+    enum {
+        k_nshards = 64 //!< Number of shards in the block table
+    };
+
 public:
     struct xm_allocator *xm_allocator_inst;
+    bool mapped; //!< Whether blocks are accessed in place
     libutil::mutex g_lock;
-    map_type g_map;
+    map_shard g_shards[k_nshards];
+
+public:
+    map_shard &get_shard(uintptr_t p) {
+        uint64_t h = uint64_t(p) * 0x9E3779B97F4A7C15ULL;
+        return g_shards[h >> 58];
+    }
+
+protected:
+    alloc_data() : xm_allocator_inst(NULL), mapped(false) { }
 };
 
 template<typename T>
@@ -41,18 +70,7 @@ public:
 public:
     /** \brief Initializes the virtual memory manager **/
     static void init(const char *prefix = 0) {
-
-        std::string path;
-
-        if (prefix) {
-            std::string pref = prefix;
-            path = pref + "/" + "xmpagefile";
-        }
-
-        if (alloc_data::get_instance().xm_allocator_inst == NULL) {
-            alloc_data::get_instance().xm_allocator_inst =
-                xm_allocator_create(prefix ? path.c_str() : NULL);
-        }
+        init_impl(prefix, false);
     }
 
     /** \brief Shuts down the memory manager
@@ -67,8 +85,13 @@ public:
 
         if (alloc_data::get_instance().xm_allocator_inst) {
             xm_allocator_destroy(alloc_data::get_instance().xm_allocator_inst);
-	    alloc_data::get_instance().xm_allocator_inst = NULL;
-	    alloc_data::get_instance().g_map.clear();
+            alloc_data::get_instance().xm_allocator_inst = NULL;
+            alloc_data::get_instance().mapped = false;
+            for (size_t i = 0; i < alloc_data::k_nshards; i++) {
+                map_shard &sh = alloc_data::get_instance().g_shards[i];
+                libutil::auto_lock<libutil::mutex> lock1(sh.lock);
+                sh.map.clear();
+            }
         }
     }
 
@@ -84,18 +107,23 @@ public:
         \return Pointer to the block of memory.
      **/
     static pointer_type allocate(size_t sz) {
-        libutil::auto_lock<libutil::mutex> lock(alloc_data::get_instance().g_lock);
         map_data data;
         data.size_bytes = get_block_size(sz);
         data.lock_ptr = NULL;
         data.n_locks = 0;
-        pointer_type p = xm_allocator_allocate(alloc_data::get_instance().xm_allocator_inst, data.size_bytes);
+        pointer_type p;
+        {
+            libutil::auto_lock<libutil::mutex> lock(alloc_data::get_instance().g_lock);
+            p = xm_allocator_allocate(alloc_data::get_instance().xm_allocator_inst, data.size_bytes);
+        }
         if (p == XM_NULL_PTR)
             throw std::runtime_error("allocate: unable to allocate memory");
-        map_type::iterator it = alloc_data::get_instance().g_map.find(p);
-        if (it != alloc_data::get_instance().g_map.end())
+        map_shard &sh = alloc_data::get_instance().get_shard(p);
+        libutil::auto_lock<libutil::mutex> lock(sh.lock);
+        map_type::iterator it = sh.map.find(p);
+        if (it != sh.map.end())
             throw std::runtime_error("allocate: pointer already allocated");
-	alloc_data::get_instance().g_map.insert(std::pair<pointer_type, map_data>(p, data));
+        sh.map.insert(std::pair<pointer_type, map_data>(p, data));
         return p;
     }
 
@@ -104,22 +132,39 @@ public:
         \param p Pointer to the block of memory.
      **/
     static void deallocate(pointer_type p) {
+        {
+            map_shard &sh = alloc_data::get_instance().get_shard(p);
+            libutil::auto_lock<libutil::mutex> lock(sh.lock);
+            map_type::iterator it = sh.map.find(p);
+            if (it == sh.map.end())
+                throw std::runtime_error("deallocate: pointer not allocated");
+            if (it->second.n_locks != 0)
+                throw std::runtime_error("deallocate: block still locked");
+            sh.map.erase(it);
+        }
         libutil::auto_lock<libutil::mutex> lock(alloc_data::get_instance().g_lock);
-        map_type::iterator it = alloc_data::get_instance().g_map.find(p);
-        if (it == alloc_data::get_instance().g_map.end())
-            throw std::runtime_error("deallocate: pointer not allocated");
-        if (it->second.n_locks != 0)
-            throw std::runtime_error("deallocate: block still locked");
-	alloc_data::get_instance().g_map.erase(it);
         xm_allocator_deallocate(alloc_data::get_instance().xm_allocator_inst, p);
     }
 
-    /** \brief Prefetches a block of memory (does nothing in this
-            implementation)
+    /** \brief Advises libxm that a block will soon be locked, so that it
+            can be read ahead from the page file
         \param p Pointer to the block of memory.
      **/
     static void prefetch(pointer_type p) {
+        if (xm_allocator_get_path(alloc_data::get_instance().xm_allocator_inst) == NULL)
+            return;
 
+        size_t size_bytes;
+        {
+            map_shard &sh = alloc_data::get_instance().get_shard(p);
+            libutil::auto_lock<libutil::mutex> lock(sh.lock);
+            map_type::iterator it = sh.map.find(p);
+            if (it == sh.map.end() || it->second.n_locks != 0)
+                return;
+            size_bytes = it->second.size_bytes;
+        }
+        xm_allocator_prefetch(alloc_data::get_instance().xm_allocator_inst,
+            p, size_bytes);
     }
 
     /** \brief Locks a block of memory in physical space for read-only
@@ -131,11 +176,15 @@ public:
         if (xm_allocator_get_path(alloc_data::get_instance().xm_allocator_inst) == NULL)
             return (const T *)p;
 
-        libutil::auto_lock<libutil::mutex> lock(alloc_data::get_instance().g_lock);
-        map_type::iterator it = alloc_data::get_instance().g_map.find(p);
-        if (it == alloc_data::get_instance().g_map.end())
+        map_shard &sh = alloc_data::get_instance().get_shard(p);
+        libutil::auto_lock<libutil::mutex> lock(sh.lock);
+        map_type::iterator it = sh.map.find(p);
+        if (it == sh.map.end())
             throw std::runtime_error("lock_ro: pointer not allocated");
-        if (it->second.lock_ptr == NULL) {
+        if (it->second.lock_ptr == NULL && alloc_data::get_instance().mapped) {
+            it->second.lock_ptr = xm_allocator_get_data(
+                alloc_data::get_instance().xm_allocator_inst, p);
+        } else if (it->second.lock_ptr == NULL) {
             it->second.lock_ptr = malloc(it->second.size_bytes);
             if (it->second.lock_ptr == NULL)
                 throw std::runtime_error("lock_ro: out of memory");
@@ -154,16 +203,17 @@ public:
         if (xm_allocator_get_path(alloc_data::get_instance().xm_allocator_inst) == NULL)
             return;
 
-        libutil::auto_lock<libutil::mutex> lock(alloc_data::get_instance().g_lock);
-        map_type::iterator it = alloc_data::get_instance().g_map.find(p);
-        if (it == alloc_data::get_instance().g_map.end())
+        map_shard &sh = alloc_data::get_instance().get_shard(p);
+        libutil::auto_lock<libutil::mutex> lock(sh.lock);
+        map_type::iterator it = sh.map.find(p);
+        if (it == sh.map.end())
             throw std::runtime_error("unlock_ro: pointer not allocated");
         if (it->second.lock_ptr == NULL)
             throw std::runtime_error("unlock_ro: pointer not locked");
         if (it->second.n_locks == 0)
             throw std::runtime_error("unlock_ro: block not locked");
         it->second.n_locks--;
-        if (it->second.n_locks == 0) {
+        if (it->second.n_locks == 0 && !alloc_data::get_instance().mapped) {
             free(it->second.lock_ptr);
             it->second.lock_ptr = NULL;
         }
@@ -186,16 +236,17 @@ public:
         if (xm_allocator_get_path(alloc_data::get_instance().xm_allocator_inst) == NULL)
             return;
 
-        libutil::auto_lock<libutil::mutex> lock(alloc_data::get_instance().g_lock);
-        map_type::iterator it = alloc_data::get_instance().g_map.find(p);
-        if (it == alloc_data::get_instance().g_map.end())
+        map_shard &sh = alloc_data::get_instance().get_shard(p);
+        libutil::auto_lock<libutil::mutex> lock(sh.lock);
+        map_type::iterator it = sh.map.find(p);
+        if (it == sh.map.end())
             throw std::runtime_error("unlock_rw: pointer not allocated");
         if (it->second.lock_ptr == NULL)
             throw std::runtime_error("unlock_rw: pointer not locked");
         if (it->second.n_locks == 0)
             throw std::runtime_error("unlock_rw: block not locked");
         it->second.n_locks--;
-        if (it->second.n_locks == 0) {
+        if (it->second.n_locks == 0 && !alloc_data::get_instance().mapped) {
             xm_allocator_write(alloc_data::get_instance().xm_allocator_inst, p,
 	        it->second.lock_ptr, it->second.size_bytes);
             free(it->second.lock_ptr);
@@ -216,6 +267,44 @@ public:
     static void unset_priority(pointer_type p) {
 
     }
+
+protected:
+    static void init_impl(const char *prefix, bool mapped) {
+
+        std::string path;
+
+        if (prefix) {
+            std::string pref = prefix;
+            path = pref + "/" + "xmpagefile";
+        }
+
+        alloc_data &ad = alloc_data::get_instance();
+        if (ad.xm_allocator_inst == NULL) {
+            const char *p = prefix ? path.c_str() : NULL;
+            ad.xm_allocator_inst = mapped ?
+                xm_allocator_create_mapped(p) : xm_allocator_create(p);
+            //  Data pointer 0 is the start of the page file, it can only be
+            //  accessed directly if libxm managed to map the file
+            ad.mapped = prefix && xm_allocator_get_data(ad.xm_allocator_inst,
+                0) != NULL;
+        }
+    }
+};
+
+
+/** \brief libxm allocator that maps the page file into memory
+
+    Blocks are accessed in place: lock_ro() and lock_rw() return pointers
+    into the mapping, and prefetch() advises the kernel to read the block
+    ahead. Selected using allocator<T>::init("libxm_mmap").
+ **/
+template<typename T>
+class lt_xm_mmap_allocator : public lt_xm_allocator<T> {
+public:
+    /** \brief Initializes the virtual memory manager **/
+    static void init(const char *prefix = 0) {
+        lt_xm_allocator<T>::init_impl(prefix, true);
+    }
 };
 
 template<typename T>
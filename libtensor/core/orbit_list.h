@@ -3,12 +3,14 @@
 
 #include <cstdlib> // for size_t
 #include <algorithm> // for std::binary_search
+#include <string>
 #include <vector>
 #include <libtensor/timings.h>
 #include "abs_index.h"
 #include "dimensions.h"
 #include "index.h"
 #include "noncopyable.h"
+#include "orbit_list_cache.h"
 #include "symmetry.h"
 
 namespace libtensor {
@@ -22,6 +24,11 @@ namespace libtensor {
     indexes in that symmetry. The list of orbits represented by their canonical
     indexes can be then iterated over using STL-like iterators.
 
+    Lists are shared through orbit_list_cache: if the same symmetry was
+    enumerated before, the list is taken from the cache. Symmetries with
+    elements that do not provide a key (symmetry_element_i::get_key()) are
+    always enumerated.
+
     \ingroup libtensor_core
  **/
 template<size_t N, typename T>
@@ -35,7 +42,7 @@ public:
 private:
     dimensions<N> m_dims; //!< Index dimensions
     magic_dimensions<N> m_mdims; //!< Magic dimensions
-    std::vector<size_t> m_orb; //!< Sorted vector of canonical indexes
+    orbit_list_cache::list_ptr m_orb; //!< Sorted vector of canonical indexes
 
 public:
     /** \brief Constructs the list of orbits
@@ -46,7 +53,7 @@ public:
     /** \brief Returns the number of orbits on the list
      **/
     size_t get_size() const {
-        return m_orb.size();
+        return m_orb->size();
     }
 
     /** \brief Returns true is the given index is a canonical one and contained
@@ -62,19 +69,19 @@ public:
         \param aidx Absolute value of an index.
      **/
     bool contains(size_t aidx) const {
-        return std::binary_search(m_orb.begin(), m_orb.end(), aidx);
+        return std::binary_search(m_orb->begin(), m_orb->end(), aidx);
     }
 
     /** \brief Returns an STL-like iterator to the beginning of the orbit list
      **/
     iterator begin() const {
-        return m_orb.begin();
+        return m_orb->begin();
     }
 
     /** \brief Returns an STL-like iterator to the end of the orbit list
      **/
     iterator end() const {
-        return m_orb.end();
+        return m_orb->end();
     }
 
     /** \brief Returns the absolute value of a canonical index pointed to by
@@ -91,7 +98,14 @@ public:
         abs_index<N>::get_index(*i, m_dims, idx);
     }
 
+    /** \brief Makes the cache key of a symmetry, returns false if some
+            element does not provide a key
+     **/
+    static bool make_key(const symmetry<N, T> &sym, std::string &key);
+
 private:
+    void build(const symmetry<N, T> &sym, std::vector<size_t> &orb);
+
     bool mark_orbit(const symmetry<N, T> &sym, size_t aidx0,
         std::vector<char> &chk);
 
@@ -0,0 +1,100 @@
+#ifndef LIBTENSOR_ORBIT_LIST_CACHE_H
+#define LIBTENSOR_ORBIT_LIST_CACHE_H
+
+#include <cstdlib> // for size_t
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <libutil/singleton.h>
+#include <libutil/threads/mutex.h>
+
+namespace libtensor {
+
+
+/** \brief Cache of orbit lists shared by all threads
+
+    Lists of canonical block indexes built by orbit_list are stored under a
+    key that encodes the block index dimensions and the contents of the
+    symmetry (see symmetry_element_i::get_key()). An orbit list requested
+    again for the same symmetry, or for an identical copy of it, is then
+    taken from the cache instead of being enumerated. A symmetry that is
+    modified yields a different key, so stale lists are never returned;
+    they are evicted in least-recently-used order once the memory held by
+    the cache exceeds the limit.
+
+    The lists are shared read-only between the cache and the orbit lists
+    that use them, so evicting an entry does not invalidate the orbit lists
+    created from it.
+
+    \ingroup libtensor_core
+ **/
+class orbit_list_cache : public libutil::singleton<orbit_list_cache> {
+    friend class libutil::singleton<orbit_list_cache>;
+
+public:
+    typedef std::shared_ptr< const std::vector<size_t> > list_ptr;
+
+private:
+    typedef std::list<std::string> lru_list;
+
+    struct entry {
+        list_ptr lst; //!< List of canonical indexes
+        lru_list::iterator pos; //!< Position in the LRU list
+    };
+
+    typedef std::unordered_map<std::string, entry> map_type;
+
+private:
+    libutil::mutex m_lock; //!< Protects the state below
+    map_type m_map; //!< Cached lists
+    lru_list m_lru; //!< Keys, most recently used first
+    size_t m_maxmem; //!< Memory limit (bytes)
+    size_t m_mem; //!< Memory in use (bytes)
+    size_t m_hits; //!< Number of hits
+    size_t m_misses; //!< Number of misses
+
+protected:
+    orbit_list_cache();
+
+public:
+    /** \brief Returns the cached list for a key, or an empty pointer if
+            the key is not in the cache
+     **/
+    static list_ptr lookup(const std::string &key);
+
+    /** \brief Stores a list in the cache
+     **/
+    static void insert(const std::string &key, const list_ptr &lst);
+
+    /** \brief Removes all the lists from the cache and resets the counters
+     **/
+    static void clear();
+
+    /** \brief Sets the memory limit in bytes (zero disables the cache)
+     **/
+    static void set_max_memory(size_t maxmem);
+    static size_t get_max_memory();
+
+    /** \brief Returns the memory held by the cached lists in bytes
+     **/
+    static size_t get_memory();
+
+    /** \brief Returns the number of cached lists
+     **/
+    static size_t get_size();
+
+    static size_t get_hits();
+    static size_t get_misses();
+
+private:
+    static size_t get_memory(const std::string &key, const list_ptr &lst);
+    void evict();
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_ORBIT_LIST_CACHE_H
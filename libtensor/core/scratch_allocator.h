@@ -0,0 +1,154 @@
+#ifndef LIBTENSOR_SCRATCH_ALLOCATOR_H
+#define LIBTENSOR_SCRATCH_ALLOCATOR_H
+
+#include <cstdlib> // for size_t
+#include "allocator.h"
+
+namespace libtensor {
+
+
+/** \brief Thread-local arena for short-lived scratch buffers
+
+    Scratch buffers are obtained from allocator<T> and kept locked in
+    physical memory. When a buffer is returned to the arena, it is cached
+    in a thread-local free list instead of being deallocated, so subsequent
+    requests of the same size class from the same thread do not go through
+    the allocator at all. Sizes are rounded up to the next power of two
+    (size classes), at most k_max_free buffers are cached per size class and
+    thread, and buffers larger than 2^k_max_class elements are not cached.
+    Each thread keeps at most get_max_cached() bytes in its free lists
+    (default k_def_max_cached), buffers that do not fit are returned to
+    the allocator, so one large operation does not pin its scratch memory
+    in every thread for the life of the process.
+
+    The cached buffers of all threads are released by purge(), which is
+    called by allocator<T>::shutdown(). Like the allocator itself, the arena
+    must not be purged while other threads are using scratch buffers.
+
+    The arena keeps global counters of the scratch memory in use, its high
+    water mark, the memory held in the free lists, and of the number of
+    requests served from the free lists (hits) or the allocator (misses).
+
+    \sa scratch_buffer
+
+    \ingroup libtensor_core
+ **/
+template<typename T>
+class scratch_allocator {
+public:
+    enum {
+        k_min_class = 6, //!< Smallest size class (log2 of the size)
+        k_max_class = 27, //!< Largest cached size class
+        k_max_free = 2 //!< Max number of cached buffers per class and thread
+    };
+
+    static const size_t k_def_max_cached; //!< Default bytes cached per thread
+
+    typedef typename allocator<T>::pointer_type pointer_type;
+
+    /** \brief Scratch buffer descriptor
+     **/
+    struct block {
+        pointer_type vp; //!< Virtual memory pointer
+        T *p; //!< Physical pointer
+        size_t sz; //!< Actual size in units of T
+    };
+
+public:
+    /** \brief Returns a locked scratch buffer of at least the given size
+        \param sz Requested size in units of T.
+     **/
+    static block allocate(size_t sz);
+
+    /** \brief Returns a scratch buffer to the arena of the calling thread
+        \param b Buffer obtained from allocate().
+     **/
+    static void deallocate(const block &b);
+
+    /** \brief Releases the cached buffers of all threads to the allocator
+     **/
+    static void purge();
+
+    /** \brief Sets the maximum number of bytes cached per thread, zero
+            disables caching
+
+        The limit applies to buffers returned afterwards, buffers already
+        cached are kept until purge().
+     **/
+    static void set_max_cached(size_t nbytes);
+
+    /** \brief Returns the maximum number of bytes cached per thread
+     **/
+    static size_t get_max_cached();
+
+    /** \brief Returns the number of bytes currently handed out
+     **/
+    static size_t get_used_bytes();
+
+    /** \brief Returns the high water mark of the bytes handed out
+     **/
+    static size_t get_peak_bytes();
+
+    /** \brief Returns the number of bytes held in the free lists
+     **/
+    static size_t get_cached_bytes();
+
+    /** \brief Returns the number of requests served from the free lists
+     **/
+    static size_t get_hits();
+
+    /** \brief Returns the number of requests served by the allocator
+     **/
+    static size_t get_misses();
+
+    /** \brief Resets the high water mark to the current usage and clears
+            the hit and miss counters
+     **/
+    static void reset_stats();
+
+    /** \brief Returns the size class of a request
+        \param sz Requested size in units of T.
+     **/
+    static size_t get_size_class(size_t sz);
+
+};
+
+
+/** \brief Scratch buffer taken from scratch_allocator for the lifetime
+        of the object
+
+    \ingroup libtensor_core
+ **/
+template<typename T>
+class scratch_buffer {
+private:
+    typename scratch_allocator<T>::block m_b; //!< Buffer
+
+public:
+    /** \brief Obtains a scratch buffer of at least the given size
+        \param sz Size in units of T.
+     **/
+    scratch_buffer(size_t sz) : m_b(scratch_allocator<T>::allocate(sz)) { }
+
+    /** \brief Returns the buffer to the arena
+     **/
+    ~scratch_buffer() {
+        scratch_allocator<T>::deallocate(m_b);
+    }
+
+    /** \brief Returns the pointer to the buffer
+     **/
+    T *get() {
+        return m_b.p;
+    }
+
+private:
+    scratch_buffer(const scratch_buffer&);
+    const scratch_buffer &operator=(const scratch_buffer&);
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_SCRATCH_ALLOCATOR_H
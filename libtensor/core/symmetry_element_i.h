@@ -1,6 +1,7 @@
 #ifndef LIBTENSOR_SYMMETRY_ELEMENT_I_H
 #define LIBTENSOR_SYMMETRY_ELEMENT_I_H
 
+#include <iosfwd>
 #include "../defs.h"
 #include "../exception.h"
 #include "block_index_space.h"
@@ -70,6 +71,17 @@ public:
      **/
     virtual void apply(index<N> &idx, tensor_transf<N, T> &tr) const = 0;
 
+    /** \brief Writes a key that identifies the action of the %symmetry
+            element on block %indexes
+        \param os Output stream.
+        \return True if the key was written. Elements that cannot be
+            identified by a key return false, which disables the caching
+            of orbit lists for the %symmetry they belong to.
+     **/
+    virtual bool get_key(std::ostream &os) const {
+        return false;
+    }
+
     //@}
 
 };
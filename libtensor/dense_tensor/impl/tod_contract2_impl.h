@@ -3,10 +3,10 @@
 
 #include <cstring> // for memset
 #include <memory>
-#include <libtensor/core/allocator.h>
 #include <libtensor/core/bad_dimensions.h>
 #include <libtensor/core/contraction2_align.h>
 #include <libtensor/core/contraction2_list_builder.h>
+#include <libtensor/core/scratch_allocator.h>
 #include <libtensor/linalg/linalg.h>
 #include <libtensor/kernels/kern_dadd1.h>
 #include <libtensor/kernels/kern_dcopy.h>
@@ -142,13 +142,13 @@ void tod_contract2<N, M, K>::perform(bool zero,
             tod_contract2<N, M, K>::stop_timer("zeroc");
         }
 
-        //  Compute the contractions grouping them by the permutation of C
+        //  Compute the contractions grouping them by the permutation of C.
+        //  The scratch buffer for permuted results is only obtained if
+        //  there is a group with a permutation other than identity
 
         bool zero1 = zero;
         double *pc1 = 0, *pc2 = 0;
-        typename allocator<double>::pointer_type vpc;
-        vpc = allocator<double>::allocate(dimsc.get_size());
-        pc1 = allocator<double>::lock_rw(vpc);
+        std::auto_ptr< scratch_buffer<double> > bufc;
 
         while(!argslst.empty()) {
 
@@ -166,20 +166,27 @@ void tod_contract2<N, M, K>::perform(bool zero,
                     tod_contract2<N, M, K>::stop_timer("zeroc");
                 }
             } else {
+                if(bufc.get() == 0) {
+                    bufc.reset(new scratch_buffer<double>(dimsc.get_size()));
+                    pc1 = bufc->get();
+                }
                 pc2 = pc1;
                 tod_contract2<N, M, K>::start_timer("zeroc1");
                 memset(pc1, 0, sizeof(double) * dimsc1.get_size());
                 tod_contract2<N, M, K>::stop_timer("zeroc1");
             }
 
+            std::list<aligned_args> argslst1;
             do {
                 if(iarg->permc.equals(permc)) {
-                    perform_internal(*iarg, pc2, dimsc1);
-                    iarg = argslst.erase(iarg);
+                    typename std::list<aligned_args>::iterator iarg1 = iarg;
+                    ++iarg;
+                    argslst1.splice(argslst1.end(), argslst, iarg1);
                 } else {
                     ++iarg;
                 }
             } while(iarg != argslst.end());
+            perform_group(argslst1, pc2, dimsc1);
 
             if(pc2 == pc1) {
 
@@ -226,8 +233,7 @@ void tod_contract2<N, M, K>::perform(bool zero,
             }
         }
 
-        allocator<double>::unlock_rw(vpc); pc1 = 0;
-        allocator<double>::deallocate(vpc);
+        bufc.reset(); pc1 = 0;
 
         cc.ret_dataptr(pc); pc = 0;
 
@@ -240,6 +246,218 @@ void tod_contract2<N, M, K>::perform(bool zero,
 }
 
 
+template<size_t N, size_t M, size_t K>
+void tod_contract2<N, M, K>::perform_group(std::list<aligned_args> &argslst,
+    double *pc, const dimensions<k_orderc> &dimsc) {
+
+    typedef typename std::list<aligned_args>::iterator iterator_t;
+
+    //  Collect arguments with identical shapes into batches
+
+    while(!argslst.empty()) {
+
+        std::list<aligned_args> batch;
+        batch.splice(batch.end(), argslst, argslst.begin());
+
+        iterator_t iarg = argslst.begin();
+        while(iarg != argslst.end()) {
+            iterator_t iarg1 = iarg;
+            ++iarg;
+            if(is_same_shape(batch.front(), *iarg1)) {
+                batch.splice(batch.end(), argslst, iarg1);
+            }
+        }
+
+        if(batch.size() == 1) {
+            perform_internal(batch.front(), pc, dimsc);
+        } else {
+            perform_batch(batch, pc, dimsc);
+        }
+    }
+}
+
+
+template<size_t N, size_t M, size_t K>
+void tod_contract2<N, M, K>::perform_batch(std::list<aligned_args> &batch,
+    double *pc, const dimensions<k_orderc> &dimsc) {
+
+    typedef typename std::list<aligned_args>::iterator iterator_t;
+    typedef typename std::list< loop_list_node<2, 1> >::iterator
+        node_iterator_t;
+
+    aligned_args &ar0 = batch.front();
+    size_t nbat = batch.size();
+
+    dimensions<k_ordera> dimsa1(ar0.ta.get_dims()); dimsa1.permute(ar0.perma);
+    dimensions<k_orderb> dimsb1(ar0.tb.get_dims()); dimsb1.permute(ar0.permb);
+    size_t sza = dimsa1.get_size(), szb = dimsb1.get_size();
+
+    contraction2<N, M, K> contr1(ar0.contr);
+    contr1.permute_a(ar0.perma);
+    contr1.permute_b(ar0.permb);
+    contr1.permute_c(ar0.permc);
+
+    std::list< loop_list_node<2, 1> > loop_in, loop_out;
+    loop_list_adapter list_adapter(loop_in);
+    contraction2_list_builder<N, M, K>(contr1).
+        populate(list_adapter, dimsa1, dimsb1, dimsc);
+
+    //  Batching is possible if all the contracted indexes form one loop.
+    //  Each argument is then either stacked as a whole (contracted indexes
+    //  are the slowest) or packed row by row (contracted indexes are
+    //  the fastest) so that the batch becomes one longer contraction.
+
+    node_iterator_t inode = loop_in.end();
+    size_t ninner = 0;
+    for(node_iterator_t i = loop_in.begin(); i != loop_in.end(); ++i) {
+        if(i->stepb(0) == 0) {
+            inode = i;
+            ninner++;
+        }
+    }
+
+    bool batchable = (ninner == 1);
+    size_t np = batchable ? inode->weight() : 0;
+    bool stacka = false, stackb = false;
+    if(batchable) {
+        batchable = (dimsc.get_size() * np <= size_t(k_batch_max));
+    }
+    if(batchable) {
+        stacka = (inode->stepa(0) * np == sza);
+        stackb = (inode->stepa(1) * np == szb);
+        if(!stacka && inode->stepa(0) != 1) batchable = false;
+        if(!stackb && inode->stepa(1) != 1) batchable = false;
+    }
+
+    if(!batchable) {
+        for(iterator_t i = batch.begin(); i != batch.end(); ++i) {
+            perform_internal(*i, pc, dimsc);
+        }
+        return;
+    }
+
+    tod_contract2<N, M, K>::start_timer("batch");
+
+    scratch_buffer<double> bufa(nbat * sza), bufb(nbat * szb);
+    double *pa = bufa.get();
+    double *pb = bufb.get();
+
+    tod_contract2<N, M, K>::start_timer("pack");
+    size_t ibat = 0;
+    for(iterator_t i = batch.begin(); i != batch.end(); ++i, ++ibat) {
+        pack(i->ta, i->perma, i->d, dimsa1, np, stacka ? 1 : nbat,
+            pa + (stacka ? ibat * sza : ibat * np));
+        pack(i->tb, i->permb, 1.0, dimsb1, np, stackb ? 1 : nbat,
+            pb + (stackb ? ibat * szb : ibat * np));
+    }
+    tod_contract2<N, M, K>::stop_timer("pack");
+
+    for(node_iterator_t i = loop_in.begin(); i != loop_in.end(); ++i) {
+        if(i == inode) continue;
+        if(!stacka) i->stepa(0) *= nbat;
+        if(!stackb) i->stepa(1) *= nbat;
+    }
+    inode->weight() *= nbat;
+
+    {
+        loop_registers<2, 1> r;
+        r.m_ptra[0] = pa;
+        r.m_ptra[1] = pb;
+        r.m_ptrb[0] = pc;
+        r.m_ptra_end[0] = pa + nbat * sza;
+        r.m_ptra_end[1] = pb + nbat * szb;
+        r.m_ptrb_end[0] = pc + dimsc.get_size();
+
+        std::auto_ptr< kernel_base<linalg, 2, 1> > kern(
+            kern_dmul2<linalg>::match(1.0, loop_in, loop_out));
+        tod_contract2<N, M, K>::start_timer("kernel");
+        tod_contract2<N, M, K>::start_timer(kern->get_name());
+        loop_list_runner<linalg, 2, 1>(loop_in).run(0, r, *kern);
+        tod_contract2<N, M, K>::stop_timer("kernel");
+        tod_contract2<N, M, K>::stop_timer(kern->get_name());
+    }
+
+    tod_contract2<N, M, K>::stop_timer("batch");
+}
+
+
+template<size_t N, size_t M, size_t K>
+bool tod_contract2<N, M, K>::is_same_shape(const aligned_args &ar1,
+    const aligned_args &ar2) {
+
+    dimensions<k_ordera> dimsa1(ar1.ta.get_dims()), dimsa2(ar2.ta.get_dims());
+    dimsa1.permute(ar1.perma);
+    dimsa2.permute(ar2.perma);
+    if(!dimsa1.equals(dimsa2)) return false;
+
+    dimensions<k_orderb> dimsb1(ar1.tb.get_dims()), dimsb2(ar2.tb.get_dims());
+    dimsb1.permute(ar1.permb);
+    dimsb2.permute(ar2.permb);
+    if(!dimsb1.equals(dimsb2)) return false;
+
+    contraction2<N, M, K> contr1(ar1.contr), contr2(ar2.contr);
+    contr1.permute_a(ar1.perma);
+    contr1.permute_b(ar1.permb);
+    contr1.permute_c(ar1.permc);
+    contr2.permute_a(ar2.perma);
+    contr2.permute_b(ar2.permb);
+    contr2.permute_c(ar2.permc);
+
+    const sequence<2 * (N + M + K), size_t> &conn1 = contr1.get_conn();
+    const sequence<2 * (N + M + K), size_t> &conn2 = contr2.get_conn();
+    for(size_t i = 0; i < 2 * (N + M + K); i++) {
+        if(conn1[i] != conn2[i]) return false;
+    }
+    return true;
+}
+
+
+template<size_t N, size_t M, size_t K>
+template<size_t NX>
+void tod_contract2<N, M, K>::pack(dense_tensor_rd_i<NX, double> &t,
+    const permutation<NX> &perm, double d, const dimensions<NX> &dims1,
+    size_t np, size_t nbat, double *p) {
+
+    //  Copies d * t permuted by perm into p. If nbat > 1, the row length
+    //  (indexes with increments of at least np) is stretched by nbat
+    //  to leave room for the other members of the batch
+
+    dense_tensor_rd_ctrl<NX, double> ct(t);
+    const dimensions<NX> &dims = t.get_dims();
+
+    sequence<NX, size_t> seq(0);
+    for(size_t i = 0; i < NX; i++) seq[i] = i;
+    perm.apply(seq);
+
+    std::list< loop_list_node<1, 1> > loop_in, loop_out;
+    for(size_t i = 0; i < NX; i++) {
+        size_t inc1 = dims1.get_increment(i);
+        if(nbat > 1 && inc1 >= np) inc1 *= nbat;
+        typename std::list< loop_list_node<1, 1> >::iterator inode =
+            loop_in.insert(loop_in.end(),
+                loop_list_node<1, 1>(dims.get_dim(seq[i])));
+        inode->stepa(0) = dims.get_increment(seq[i]);
+        inode->stepb(0) = inc1;
+    }
+
+    const double *pt = ct.req_const_dataptr();
+
+    loop_registers<1, 1> r;
+    r.m_ptra[0] = pt;
+    r.m_ptrb[0] = p;
+    r.m_ptra_end[0] = pt + dims.get_size();
+    r.m_ptrb_end[0] = p + dims1.get_size() * nbat;
+
+    {
+        std::auto_ptr< kernel_base<linalg, 1, 1> > kern(
+            kern_dcopy<linalg>::match(d, loop_in, loop_out));
+        loop_list_runner<linalg, 1, 1>(loop_in).run(0, r, *kern);
+    }
+
+    ct.ret_const_dataptr(pt);
+}
+
+
 template<size_t N, size_t M, size_t K>
 void tod_contract2<N, M, K>::perform_internal(aligned_args &ar,
     double *pc, const dimensions<k_orderc> &dimsc) {
@@ -257,13 +475,13 @@ void tod_contract2<N, M, K>::perform_internal(aligned_args &ar,
     double *pa1 = 0, *pb1 = 0;
     const double *pa2 = 0, *pb2 = 0;
 
-    typename allocator<double>::pointer_type vpa, vpb;
+    std::auto_ptr< scratch_buffer<double> > bufa, bufb;
 
     pa2 = pa = ca.req_const_dataptr();
     if(!ar.perma.is_identity()) {
 
-        vpa = allocator<double>::allocate(dimsa1.get_size());
-        pa1 = allocator<double>::lock_rw(vpa);
+        bufa.reset(new scratch_buffer<double>(dimsa1.get_size()));
+        pa1 = bufa->get();
 
         sequence<k_ordera, size_t> seqa(0);
         for(size_t i = 0; i < k_ordera; i++) seqa[i] = i;
@@ -308,8 +526,8 @@ void tod_contract2<N, M, K>::perform_internal(aligned_args &ar,
     pb2 = pb = cb.req_const_dataptr();
     if(!ar.permb.is_identity()) {
 
-        vpb = allocator<double>::allocate(dimsb1.get_size());
-        pb1 = allocator<double>::lock_rw(vpb);
+        bufb.reset(new scratch_buffer<double>(dimsb1.get_size()));
+        pb1 = bufb->get();
 
         sequence<k_orderb, size_t> seqb(0);
         for(size_t i = 0; i < k_orderb; i++) seqb[i] = i;
@@ -379,16 +597,10 @@ void tod_contract2<N, M, K>::perform_internal(aligned_args &ar,
         tod_contract2<N, M, K>::stop_timer(kern->get_name());
     }
 
-    if(pa1) {
-        allocator<double>::unlock_rw(vpa); pa1 = 0;
-        allocator<double>::deallocate(vpa);
-    }
+    bufa.reset(); pa1 = 0;
     ca.ret_const_dataptr(pa);
 
-    if(pb1) {
-        allocator<double>::unlock_rw(vpb); pb1 = 0;
-        allocator<double>::deallocate(vpb);
-    }
+    bufb.reset(); pb1 = 0;
     cb.ret_const_dataptr(pb);
 }
 
@@ -31,7 +31,17 @@ namespace libtensor {
     contractions at once, the algorithm makes more efficient use of internal
     buffers, which leads to higher performance.
 
-    \sa dense_tensor_i, contraction2
+    Small contractions in the argument list that have identical shapes after
+    alignment are executed as a single matrix multiplication: the arguments
+    are packed into contiguous buffers side by side along the contracted
+    index. This removes the overhead of many tiny BLAS calls when a result
+    block receives contributions from many small blocks.
+
+    Temporary buffers for permuted arguments and results are taken from
+    the thread-local scratch_allocator. The buffer for the result is only
+    needed if the result of some argument is permuted.
+
+    \sa dense_tensor_i, contraction2, scratch_allocator
 
     \ingroup libtensor_dense_tensor_tod
  **/
@@ -49,6 +59,11 @@ public:
         k_orderc = N + M //!< Order of result (C)
     };
 
+    enum {
+        //! Max number of multiply-adds in one contraction to be batched
+        k_batch_max = 32768
+    };
+
 private:
     struct args {
         contraction2<N, M, K> contr; //!< Contraction
@@ -177,6 +192,20 @@ private:
 
     void perform_internal(aligned_args &ar, double *pc,
         const dimensions<k_orderc> &dimsc);
+
+    void perform_group(std::list<aligned_args> &argslst, double *pc,
+        const dimensions<k_orderc> &dimsc);
+
+    void perform_batch(std::list<aligned_args> &batch, double *pc,
+        const dimensions<k_orderc> &dimsc);
+
+    static bool is_same_shape(const aligned_args &ar1,
+        const aligned_args &ar2);
+
+    template<size_t NX>
+    static void pack(dense_tensor_rd_i<NX, double> &t,
+        const permutation<NX> &perm, double d, const dimensions<NX> &dims1,
+        size_t np, size_t nbat, double *p);
 };
 
 
@@ -8,6 +8,9 @@ namespace libtensor {
 namespace expr {
 
 
+class eval_cost;
+
+
 /** \brief Processor of evaluation plan for btensor result type (double)
 
     \ingroup libtensor_expr_btensor
@@ -32,11 +35,104 @@ public:
      **/
     virtual void evaluate(const expr_tree &tree) const;
 
+    /** \brief Estimates the cost of evaluating an expression tree without
+            evaluating it
+        \param tree Expression tree.
+        \param[out] cost Receives the records of the evaluation steps and
+            the predicted peak memory of intermediates.
+     **/
+    void estimate(const expr_tree &tree, eval_cost &cost) const;
+
 public:
     /** \brief Specifies whether to use libxm contractions (if available)
      **/
     static void use_libxm(bool usexm);
 
+    /** \brief Sets the memory budget in bytes for intermediates evaluated
+            concurrently
+
+        Intermediates that do not depend on each other are evaluated at the
+        same time as tasks of the thread pool associated with the calling
+        thread. The steps run together are chosen so that the sum of the
+        sizes of the intermediates they form stays within the budget. The
+        size of an intermediate is the dense upper bound: the product of
+        its dimensions times the element size, regardless of symmetry and
+        zero blocks. Tensors read by the steps, intermediates formed
+        earlier and the scratch memory of the operations are not counted.
+        Steps whose size is unknown are always run alone.
+
+        Zero (default) disables the concurrent evaluation of intermediates,
+        the steps are then evaluated one at a time in order.
+     **/
+    static void set_parallel_memory(size_t maxmem);
+
+    /** \brief Returns the memory budget for intermediates evaluated
+            concurrently
+     **/
+    static size_t get_parallel_memory();
+
+    /** \brief Sets the size in bytes above which intermediates are
+            evaluated directly
+
+        The blocks of a direct intermediate are not stored, they are
+        computed when requested by the contraction that reads the
+        intermediate and dropped when no longer needed. Only intermediates
+        read once by a contraction qualify. Intermediates marked with
+        direct() in the expression are always made direct. With a non-zero
+        threshold, so are the ones whose size (dense upper bound: the
+        product of the dimensions times the element size) is at least the
+        threshold. Blocks of a direct intermediate are recomputed each time
+        the contraction requests them, so this trades computation for
+        memory.
+
+        Zero (default) leaves only the marked intermediates direct.
+     **/
+    static void set_direct_memory(size_t minmem);
+
+    /** \brief Returns the size above which intermediates are evaluated
+            directly
+     **/
+    static size_t get_direct_memory();
+
+    /** \brief Sets the length of blocks contractions are carried out on
+
+        Small blocks, as they often result from the splits required by the
+        symmetry, make contractions spend their time on per-block overhead
+        and multiply small matrices. With a non-zero length, neighbouring
+        blocks of the arguments of a contraction are merged until they are
+        at least that many elements long along each dimension, the
+        contraction is done on the merged blocks and the result is split
+        back into the original blocks. This needs memory for merged copies
+        of the arguments and of the result and is only done for arguments
+        with permutational symmetry alone. Zero (default) disables merging.
+     **/
+    static void set_reblock_length(size_t len);
+
+    /** \brief Returns the length of blocks contractions are carried out on
+     **/
+    static size_t get_reblock_length();
+
+    /** \brief Enables the blockwise symmetrization of contractions
+
+        When enabled, two-index symmetrizations of contractions compute each
+        canonical block of the result at once from the blocks of the
+        contraction (btod_symmetrize2 blockwise mode) instead of streaming
+        all the blocks of the contraction into the result, which then
+        accumulates several contributions per block. The lists of non-zero
+        blocks of the arguments are made once per contraction and shared by
+        all the blocks. Enabled by default.
+     **/
+    static void set_symmetrize_blockwise(bool blockwise);
+
+    /** \brief Returns whether contractions are symmetrized blockwise
+     **/
+    static bool get_symmetrize_blockwise();
+
+    /** \brief Returns the peak memory in bytes held by the blocks of
+            intermediates during the last evaluated expression
+     **/
+    static size_t get_interm_peak();
+
 };
 
 
@@ -0,0 +1,74 @@
+#ifndef LIBTENSOR_EXPR_EVAL_BTENSOR_DRYRUN_H
+#define LIBTENSOR_EXPR_EVAL_BTENSOR_DRYRUN_H
+
+#include <libtensor/core/noncopyable.h>
+#include <libtensor/expr/eval/eval_i.h>
+#include "eval_btensor.h"
+#include "eval_cost.h"
+
+namespace libtensor {
+namespace expr {
+
+
+/** \brief Estimates the cost of btensor expressions instead of evaluating
+        them
+
+    While an object of this class exists, it is registered ahead of the
+    other expression evaluators and takes all btensor expressions of
+    double elements. Each expression is optimized and planned as for the
+    evaluation, then the operations of all the steps are set up on the
+    symmetry and non-zero blocks of their arguments, intermediates only
+    have the blocks they would have. No tensor data is read or written,
+    and the tensors on the left-hand side are left unchanged.
+
+    The estimates of all expressions are collected in one eval_cost object
+    (\sa eval_btensor<double>::estimate()).
+
+    \ingroup libtensor_expr_btensor
+ **/
+class eval_btensor_dryrun : public eval_i, public noncopyable {
+public:
+    enum {
+        Nmax = eval_btensor<double>::Nmax
+    };
+
+private:
+    eval_btensor<double> m_eval; //!< Evaluator that plans the expressions
+    mutable eval_cost m_cost; //!< Estimated cost
+
+public:
+    /** \brief Registers the dry-run evaluator
+     **/
+    eval_btensor_dryrun();
+
+    /** \brief Removes the dry-run evaluator from the register
+     **/
+    virtual ~eval_btensor_dryrun();
+
+    /** \brief Checks if this evaluator can handle the given expression
+     **/
+    virtual bool can_evaluate(const expr_tree &e) const;
+
+    /** \brief Estimates the cost of an expression tree
+     **/
+    virtual void evaluate(const expr_tree &tree) const;
+
+    /** \brief Returns the estimated cost of the expressions so far
+     **/
+    const eval_cost &get_cost() const {
+        return m_cost;
+    }
+
+    /** \brief Discards the estimates
+     **/
+    void reset() {
+        m_cost.reset();
+    }
+
+};
+
+
+} // namespace expr
+} // namespace libtensor
+
+#endif // LIBTENSOR_EXPR_EVAL_BTENSOR_DRYRUN_H
@@ -0,0 +1,92 @@
+#ifndef LIBTENSOR_EXPR_EVAL_COST_H
+#define LIBTENSOR_EXPR_EVAL_COST_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace libtensor {
+namespace expr {
+
+
+/** \brief Estimated cost of the evaluation of expressions
+
+    Holds one record per step of the evaluation plans of the estimated
+    expressions: the operation that forms the result, the number of
+    canonical non-zero blocks of the result and the memory they take, and
+    for contractions the number of block contractions and floating-point
+    operations. The peak memory of intermediates is the maximum over the
+    estimated expressions.
+
+    \sa eval_btensor_dryrun
+
+    \ingroup libtensor_expr_btensor
+ **/
+class eval_cost {
+public:
+    struct step {
+        std::string op; //!< Operation that forms the result
+        size_t n; //!< Order of the result (zero for scalars)
+        bool interm; //!< Whether the result is an intermediate
+        bool direct; //!< Whether the intermediate is evaluated directly
+        size_t nblk; //!< Number of canonical non-zero blocks
+        size_t bytes; //!< Memory taken by the non-zero blocks (bytes)
+        size_t npairs; //!< Number of block contractions
+        double nflops; //!< Floating-point operations in contractions
+
+        step() :
+            n(0), interm(false), direct(false), nblk(0), bytes(0),
+            npairs(0), nflops(0.0)
+        { }
+    };
+
+private:
+    std::vector<step> m_steps; //!< Evaluation steps
+    size_t m_peak; //!< Peak memory of intermediates (bytes)
+
+public:
+    eval_cost() : m_peak(0) { }
+
+    /** \brief Adds a record of one evaluation step
+     **/
+    void add_step(const step &s) {
+        m_steps.push_back(s);
+    }
+
+    /** \brief Updates the peak memory of intermediates
+     **/
+    void add_peak(size_t peak) {
+        if(peak > m_peak) m_peak = peak;
+    }
+
+    /** \brief Returns the records of evaluation steps
+     **/
+    const std::vector<step> &get_steps() const {
+        return m_steps;
+    }
+
+    /** \brief Returns the peak memory in bytes held by intermediates
+     **/
+    size_t get_interm_peak() const {
+        return m_peak;
+    }
+
+    /** \brief Returns the total number of floating-point operations
+     **/
+    double get_flops() const;
+
+    /** \brief Removes all records
+     **/
+    void reset();
+
+    /** \brief Prints the records as a table, one line per step
+     **/
+    void print(std::ostream &os) const;
+
+};
+
+
+} // namespace expr
+} // namespace libtensor
+
+#endif // LIBTENSOR_EXPR_EVAL_COST_H
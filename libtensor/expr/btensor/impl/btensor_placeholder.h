@@ -1,7 +1,9 @@
 #ifndef LIBTENSOR_EXPR_BTENSOR_PLACEHOLDER_H
 #define LIBTENSOR_EXPR_BTENSOR_PLACEHOLDER_H
 
+#include <memory>
 #include <libtensor/expr/btensor/btensor.h>
+#include "interm_pool.h"
 
 namespace libtensor {
 namespace expr {
@@ -11,6 +13,25 @@ class btensor_placeholder_base : public noncopyable {
 public:
     virtual ~btensor_placeholder_base() { };
 
+    /** \brief Destroys the block tensor or returns it to the pool
+     **/
+    virtual void destroy_btensor() = 0;
+
+};
+
+
+/** \brief Block tensor whose blocks are computed on demand, owns the
+        operation that computes them
+ **/
+template<size_t N, typename T>
+class btensor_direct_i {
+public:
+    virtual ~btensor_direct_i() { }
+
+    /** \brief Returns the direct block tensor
+     **/
+    virtual block_tensor_rd_i<N, T> &get_bt() = 0;
+
 };
 
 
@@ -23,9 +44,15 @@ public:
 
 private:
     btensor<N, T> *m_bt; //!< Pointer to the real tensor
+    btensor_direct_i<N, T> *m_dbt; //!< Direct tensor (instead of real one)
+    std::shared_ptr<interm_pool> m_pool; //!< Pool of intermediates (optional)
 
 public:
-    btensor_placeholder() : any_tensor<N, T>(*this), m_bt(0) {
+    btensor_placeholder() : any_tensor<N, T>(*this), m_bt(0), m_dbt(0) {
+    }
+
+    btensor_placeholder(const std::shared_ptr<interm_pool> &pool) :
+        any_tensor<N, T>(*this), m_bt(0), m_dbt(0), m_pool(pool) {
     }
 
     virtual ~btensor_placeholder() {
@@ -38,16 +65,38 @@ public:
 
     void create_btensor(const block_index_space<N> &bis) {
         destroy_btensor();
-        m_bt = new btensor<N, T>(bis);
+        if(m_pool) m_bt = m_pool->template acquire<N, T>(bis);
+        else m_bt = new btensor<N, T>(bis);
+    }
+
+    /** \brief Makes the placeholder refer to a direct block tensor, takes
+            the ownership of the object
+     **/
+    void create_direct(btensor_direct_i<N, T> *dbt) {
+        destroy_btensor();
+        m_dbt = dbt;
     }
 
-    void destroy_btensor() {
-        delete m_bt;
+    virtual void destroy_btensor() {
+        delete m_dbt;
+        m_dbt = 0;
+        if(m_bt == 0) return;
+        if(m_pool) m_pool->release(m_bt);
+        else delete m_bt;
         m_bt = 0;
     }
 
     bool is_empty() const {
-        return m_bt == 0;
+        return m_bt == 0 && m_dbt == 0;
+    }
+
+    bool is_direct() const {
+        return m_dbt != 0;
+    }
+
+    block_tensor_rd_i<N, T> &get_rd_btensor() const {
+        if(m_dbt != 0) return m_dbt->get_bt();
+        return get_btensor();
     }
 
     btensor<N, T> &get_btensor() const {
@@ -0,0 +1,321 @@
+#ifndef LIBTENSOR_EXPR_CONTRACT_REBLOCK_H
+#define LIBTENSOR_EXPR_CONTRACT_REBLOCK_H
+
+#include <memory>
+#include <libutil/thread_pool/thread_pool.h>
+#include <libtensor/core/abs_index.h>
+#include <libtensor/core/allocator.h>
+#include <libtensor/core/noncopyable.h>
+#include <libtensor/block_tensor/block_tensor.h>
+#include <libtensor/block_tensor/btod_contract2.h>
+#include <libtensor/block_tensor/btod_reblock.h>
+#include <libtensor/dense_tensor/dense_tensor.h>
+#include <libtensor/gen_block_tensor/addition_schedule.h>
+#include <libtensor/gen_block_tensor/gen_block_tensor_ctrl.h>
+#include <libtensor/gen_block_tensor/gen_bto_aux_add.h>
+#include <libtensor/gen_block_tensor/gen_bto_aux_copy.h>
+
+namespace libtensor {
+namespace expr {
+namespace eval_btensor_double {
+
+
+/** \brief Contraction of two block tensors carried out on larger blocks
+    \tparam N Order of first tensor less contraction degree.
+    \tparam M Order of second tensor less contraction degree.
+    \tparam K Contraction degree.
+
+    Before the contraction, the blocks of both arguments are merged until
+    they are at least the given length along each dimension (see
+    btod_reblock<N>::make_splits()). The contraction runs on the merged
+    copies with fewer, larger blocks, which lowers the overhead per block
+    and lets the matrix multiplications run on larger matrices. The
+    result is split back into the original block structure as it is
+    written out.
+
+    The result is the same as that of btod_contract2<N, M, K> on the
+    original arguments, which also provides the block index space,
+    symmetry and schedule of the result, and computes single blocks
+    requested through compute_block(). Only arguments with permutational
+    symmetry can be reblocked (see is_applicable()).
+
+    \ingroup libtensor_expr_btensor
+ **/
+template<size_t N, size_t M, size_t K>
+class contract_reblock :
+    public additive_gen_bto<N + M, btod_traits::bti_traits>,
+    public noncopyable {
+
+public:
+    enum {
+        NA = N + K, //!< Order of first argument
+        NB = M + K, //!< Order of second argument
+        NC = N + M //!< Order of result
+    };
+
+    typedef btod_traits::bti_traits bti_traits;
+
+private:
+    class task : public libutil::task_i {
+    private:
+        btod_reblock<NC> &m_rb;
+        index<NC> m_idx;
+        gen_block_stream_i<NC, bti_traits> &m_out;
+
+    public:
+        task(btod_reblock<NC> &rb, const index<NC> &idx,
+            gen_block_stream_i<NC, bti_traits> &out) :
+            m_rb(rb), m_idx(idx), m_out(out)
+        { }
+
+        virtual ~task() { }
+        virtual unsigned long get_cost() const { return 0; }
+
+        virtual void perform() {
+            dense_tensor< NC, double, allocator<double> > blk(
+                m_rb.get_bis().get_block_dims(m_idx));
+            m_rb.compute_block_untimed(m_idx, blk);
+            m_out.put(m_idx, blk, tensor_transf<NC, double>());
+        }
+    };
+
+    class task_iterator : public libutil::task_iterator_i {
+    private:
+        btod_reblock<NC> &m_rb;
+        gen_block_stream_i<NC, bti_traits> &m_out;
+        dimensions<NC> m_bidims;
+        const assignment_schedule<NC, double> &m_sch;
+        typename assignment_schedule<NC, double>::iterator m_i;
+
+    public:
+        task_iterator(btod_reblock<NC> &rb,
+            const assignment_schedule<NC, double> &sch,
+            gen_block_stream_i<NC, bti_traits> &out) :
+            m_rb(rb), m_out(out),
+            m_bidims(m_rb.get_bis().get_block_index_dims()), m_sch(sch),
+            m_i(m_sch.begin())
+        { }
+
+        virtual bool has_more() const {
+            return m_i != m_sch.end();
+        }
+
+        virtual libutil::task_i *get_next() {
+            index<NC> idx;
+            abs_index<NC>::get_index(m_sch.get_abs_index(m_i), m_bidims, idx);
+            ++m_i;
+            return new task(m_rb, idx, m_out);
+        }
+    };
+
+    class task_observer : public libutil::task_observer_i {
+    public:
+        virtual void notify_start_task(libutil::task_i *t) { }
+        virtual void notify_finish_task(libutil::task_i *t) { delete t; }
+    };
+
+private:
+    contraction2<N, M, K> m_contr; //!< Contraction
+    block_tensor_rd_i<NA, double> &m_bta; //!< First argument
+    double m_ka; //!< Scaling coefficient of first argument
+    block_tensor_rd_i<NB, double> &m_btb; //!< Second argument
+    double m_kb; //!< Scaling coefficient of second argument
+    double m_kc; //!< Scaling coefficient of result
+    block_index_space<NA> m_bisa; //!< Merged blocks of first argument
+    block_index_space<NB> m_bisb; //!< Merged blocks of second argument
+    btod_contract2<N, M, K> m_op; //!< Contraction on original blocks
+
+public:
+    /** \brief Initializes the contraction
+        \param contr Contraction.
+        \param bta First argument.
+        \param ka Scaling coefficient of first argument.
+        \param btb Second argument.
+        \param kb Scaling coefficient of second argument.
+        \param kc Scaling coefficient of result.
+        \param len Target length of merged blocks.
+     **/
+    contract_reblock(const contraction2<N, M, K> &contr,
+        block_tensor_rd_i<NA, double> &bta, double ka,
+        block_tensor_rd_i<NB, double> &btb, double kb, double kc,
+        size_t len) :
+
+        m_contr(contr), m_bta(bta), m_ka(ka), m_btb(btb), m_kb(kb), m_kc(kc),
+        m_bisa(merge_blocks(bta.get_bis(), len)),
+        m_bisb(merge_blocks(btb.get_bis(), len)),
+        m_op(contr, bta, ka, btb, kb, kc)
+    { }
+
+    virtual ~contract_reblock() { }
+
+    /** \brief Returns the contraction on the original blocks
+     **/
+    btod_contract2<N, M, K> &get_op() {
+        return m_op;
+    }
+
+    virtual const block_index_space<NC> &get_bis() const {
+        return m_op.get_bis();
+    }
+
+    virtual const symmetry<NC, double> &get_symmetry() const {
+        return m_op.get_symmetry();
+    }
+
+    virtual const assignment_schedule<NC, double> &get_schedule() const {
+        return m_op.get_schedule();
+    }
+
+    virtual void perform(gen_block_stream_i<NC, bti_traits> &out);
+
+    virtual void perform(gen_block_tensor_i<NC, bti_traits> &btc) {
+        gen_bto_aux_copy<NC, btod_traits> out(get_symmetry(), btc);
+        out.open();
+        perform(out);
+        out.close();
+    }
+
+    virtual void perform(gen_block_tensor_i<NC, bti_traits> &btc,
+        const scalar_transf<double> &c);
+
+    virtual void compute_block(
+        bool zero,
+        const index<NC> &ic,
+        const tensor_transf<NC, double> &trc,
+        dense_tensor_wr_i<NC, double> &blkc) {
+
+        m_op.compute_block(zero, ic, trc, blkc);
+    }
+
+    virtual void compute_block(
+        const index<NC> &ic,
+        dense_tensor_wr_i<NC, double> &blkc) {
+
+        m_op.compute_block(ic, blkc);
+    }
+
+    /** \brief Returns true if the arguments can be reblocked and some of
+            their blocks are shorter than the given length
+     **/
+    static bool is_applicable(block_tensor_rd_i<NA, double> &bta,
+        block_tensor_rd_i<NB, double> &btb, size_t len);
+
+private:
+    template<size_t L>
+    static block_index_space<L> merge_blocks(const block_index_space<L> &bis,
+        size_t len);
+
+    template<size_t L>
+    static bool check_arg(block_tensor_rd_i<L, double> &bt, size_t len,
+        bool &merge);
+
+};
+
+
+template<size_t N, size_t M, size_t K>
+void contract_reblock<N, M, K>::perform(
+    gen_block_stream_i<NC, bti_traits> &out) {
+
+    typedef allocator<double> allocator_type;
+
+    //  Merged copies of the arguments are only kept until the contraction
+    //  is done, the merged result until it is split back
+
+    std::auto_ptr< block_tensor<NC, double, allocator_type> > btc;
+    {
+        block_tensor<NA, double, allocator_type> bta(m_bisa);
+        block_tensor<NB, double, allocator_type> btb(m_bisb);
+        btod_reblock<NA>(m_bta, m_bisa).perform(bta);
+        btod_reblock<NB>(m_btb, m_bisb).perform(btb);
+        btod_contract2<N, M, K> op(m_contr, bta, m_ka, btb, m_kb, m_kc);
+        btc.reset(new block_tensor<NC, double, allocator_type>(op.get_bis()));
+        op.perform(*btc);
+    }
+
+    btod_reblock<NC> rb(*btc, get_bis());
+    task_iterator ti(rb, get_schedule(), out);
+    task_observer to;
+    libutil::thread_pool::submit(ti, to);
+}
+
+
+template<size_t N, size_t M, size_t K>
+void contract_reblock<N, M, K>::perform(
+    gen_block_tensor_i<NC, bti_traits> &btc,
+    const scalar_transf<double> &c) {
+
+    gen_block_tensor_rd_ctrl<NC, bti_traits> cc(btc);
+    std::vector<size_t> nzblkc;
+    cc.req_nonzero_blocks(nzblkc);
+    addition_schedule<NC, btod_traits> asch(get_symmetry(),
+        cc.req_const_symmetry());
+    asch.build(get_schedule(), nzblkc);
+
+    gen_bto_aux_add<NC, btod_traits> out(get_symmetry(), asch, btc, c);
+    out.open();
+    perform(out);
+    out.close();
+}
+
+
+template<size_t N, size_t M, size_t K>
+bool contract_reblock<N, M, K>::is_applicable(
+    block_tensor_rd_i<NA, double> &bta, block_tensor_rd_i<NB, double> &btb,
+    size_t len) {
+
+    bool merge = false;
+    return len > 0 && check_arg(bta, len, merge) &&
+        check_arg(btb, len, merge) && merge;
+}
+
+
+template<size_t N, size_t M, size_t K> template<size_t L>
+block_index_space<L> contract_reblock<N, M, K>::merge_blocks(
+    const block_index_space<L> &bis, size_t len) {
+
+    //  Dimensions of the same type are split the same way, which keeps
+    //  the permutational symmetry valid and the contracted dimensions of
+    //  both arguments compatible
+
+    block_index_space<L> bis1(bis.get_dims());
+    mask<L> done;
+    for(size_t i = 0; i < L; i++) {
+        if(done[i]) continue;
+        size_t typ = bis.get_type(i);
+        mask<L> msk;
+        for(size_t j = i; j < L; j++) {
+            if(bis.get_type(j) == typ) msk[j] = done[j] = true;
+        }
+        split_points sp;
+        btod_reblock<L>::make_splits(bis.get_splits(typ),
+            bis.get_dims().get_dim(i), len, sp);
+        for(size_t j = 0; j < sp.get_num_points(); j++) bis1.split(msk, sp[j]);
+    }
+    return bis1;
+}
+
+
+template<size_t N, size_t M, size_t K> template<size_t L>
+bool contract_reblock<N, M, K>::check_arg(
+    block_tensor_rd_i<L, double> &bt, size_t len, bool &merge) {
+
+    gen_block_tensor_rd_ctrl<L, bti_traits> ctrl(bt);
+    if(!btod_reblock<L>::is_reblockable(ctrl.req_const_symmetry())) {
+        return false;
+    }
+
+    const block_index_space<L> &bis = bt.get_bis();
+    for(size_t i = 0; i < L; i++) {
+        split_points sp;
+        if(btod_reblock<L>::make_splits(bis.get_splits(bis.get_type(i)),
+            bis.get_dims().get_dim(i), len, sp)) merge = true;
+    }
+    return true;
+}
+
+
+} // namespace eval_btensor_double
+} // namespace expr
+} // namespace libtensor
+
+#endif // LIBTENSOR_EXPR_CONTRACT_REBLOCK_H
@@ -38,6 +38,12 @@ public:
         return m_impl->get_bto();
     }
 
+    /** \brief Estimates the cost of the sum
+     **/
+    virtual bool get_cost(size_t &npairs, double &nflops) const {
+        return m_impl->get_cost(npairs, nflops);
+    }
+
 };
 
 
@@ -39,6 +39,12 @@ public:
         return m_impl->get_bto();
     }
 
+    /** \brief Estimates the cost of the operation
+     **/
+    virtual bool get_cost(size_t &npairs, double &nflops) const {
+        return m_impl->get_cost(npairs, nflops);
+    }
+
     /** \brief Evaluates the result into given node
      **/
     void evaluate(node_id_t lhs, bool add);
@@ -39,10 +39,17 @@ public:
         return m_impl->get_bto();
     }
 
+    /** \brief Estimates the cost of the contraction
+     **/
+    virtual bool get_cost(size_t &npairs, double &nflops) const {
+        return m_impl->get_cost(npairs, nflops);
+    }
+
 };
 
 
 extern bool use_libxm; //!< Swtich between native/libxm btod_contract
+extern size_t reblock_length; //!< Target length of blocks in contractions
 
 
 } // namespace eval_btensor_double
@@ -0,0 +1,76 @@
+#ifndef LIBTENSOR_EXPR_EVAL_BTENSOR_DOUBLE_EWISE_H
+#define LIBTENSOR_EXPR_EVAL_BTENSOR_DOUBLE_EWISE_H
+
+#include "../eval_btensor.h"
+#include "eval_btensor_evaluator_i.h"
+
+namespace libtensor {
+namespace expr {
+namespace eval_btensor_double {
+
+
+/** \brief Evaluates chains of element-wise operations in one pass
+
+    The subexpression made of sums, quotients and element-wise products
+    of tensors of the same order, with any permutations and scaling of the
+    terms, is compiled into one btod_ewise operation. Each block of the
+    arguments is read once and each block of the result is written once,
+    no matter how many operations are in the chain.
+
+    \sa is_ewise_op(), ewise_region()
+ **/
+template<size_t N>
+class ewise : public eval_btensor_evaluator_i<N, double> {
+public:
+    enum {
+        Nmax = eval_btensor<double>::Nmax
+    };
+
+    typedef typename eval_btensor_evaluator_i<N, double>::bti_traits bti_traits;
+    typedef expr_tree::node_id_t node_id_t; //!< Node ID type
+
+private:
+    eval_btensor_evaluator_i<N, double> *m_impl;
+
+public:
+    /** \brief Initializes the evaluator
+     **/
+    ewise(const expr_tree &tree, node_id_t &id,
+        const tensor_transf<N, double> &tr);
+
+    /** \brief Virtual destructor
+     **/
+    virtual ~ewise();
+
+    /** \brief Returns the block tensor operation
+     **/
+    virtual additive_gen_bto<N, bti_traits> &get_bto() const {
+        return m_impl->get_bto();
+    }
+
+};
+
+
+/** \brief Checks whether the node is a sum, a quotient or an element-wise
+        product of two tensors of the same order
+ **/
+bool is_ewise_op(const graph &g, graph::node_id_t id);
+
+
+/** \brief Checks whether the subexpression can be evaluated by ewise<N>
+    \param g Expression graph.
+    \param id Head of the subexpression.
+    \param[in,out] nops Incremented by the number of element-wise
+        operations in the subexpression.
+    \return True if the subexpression consists only of sums, quotients
+        and element-wise products of tensors (or of shared subexpressions,
+        which become intermediates).
+ **/
+bool ewise_region(const graph &g, graph::node_id_t id, size_t &nops);
+
+
+} // namespace eval_btensor_double
+} // namespace expr
+} // namespace libtensor
+
+#endif // LIBTENSOR_EXPR_EVAL_BTENSOR_DOUBLE_EWISE_H
@@ -38,9 +38,18 @@ public:
         return m_impl->get_bto();
     }
 
+    /** \brief Estimates the cost of the symmetrized operation
+     **/
+    virtual bool get_cost(size_t &npairs, double &nflops) const {
+        return m_impl->get_cost(npairs, nflops);
+    }
+
 };
 
 
+extern bool symmetrize_blockwise; //!< Symmetrize contractions blockwise
+
+
 } // namespace eval_btensor_double
 } // namespace expr
 } // namespace libtensor
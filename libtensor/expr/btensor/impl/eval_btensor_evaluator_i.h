@@ -22,6 +22,14 @@ public:
      **/
     virtual additive_gen_bto<N, bti_traits> &get_bto() const = 0;
 
+    /** \brief Estimates the number of block contractions and floating-point
+            operations of the operation without performing it
+        \return False if the cost of the operation is not known.
+     **/
+    virtual bool get_cost(size_t &npairs, double &nflops) const {
+        return false;
+    }
+
 };
 
 
@@ -0,0 +1,118 @@
+#ifndef LIBTENSOR_EXPR_EVAL_PLAN_CACHE_H
+#define LIBTENSOR_EXPR_EVAL_PLAN_CACHE_H
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <libutil/singleton.h>
+#include <libutil/threads/mutex.h>
+#include <libtensor/expr/dag/expr_tree.h>
+
+namespace libtensor {
+namespace expr {
+
+
+/** \brief Expression tree optimized for evaluation
+
+    The plan is the result of the optimization passes applied to an
+    expression. The tensors and scalars it refers to are those of the
+    expression the plan was made from. Before the plan is used for another
+    expression with the same key, these leaves are replaced by the ones of
+    the new expression: each leaf is given as the ID of the node in the
+    plan and the position of the leaf in the key of the expression.
+
+    \ingroup libtensor_expr_btensor
+ **/
+struct eval_plan {
+    expr_tree tree; //!< Optimized expression tree
+    std::vector< std::pair<expr_tree::node_id_t, size_t> > leaves; //!< Leaves
+
+    eval_plan(const expr_tree &tr) : tree(tr) { }
+};
+
+
+/** \brief Cache of evaluation plans shared by all threads
+
+    Expressions that are evaluated repeatedly with the same structure and
+    the same tensors, such as in iterative solvers, only need to be
+    optimized once. The plans are stored under a key that encodes the
+    operations of the expression with their parameters, the order, type,
+    dimensions and symmetry of its tensors, and which of the tensors are
+    the same. Expressions on tensors with a different symmetry get plans of
+    their own, since the contraction order depends on it. The least
+    recently used plans are evicted once the number of plans exceeds the
+    limit (64 by default).
+
+    Only the optimized expression tree is cached. The symmetries of the
+    results and the block lists of the contractions are computed by the
+    block tensor operations on every evaluation, with the orbit lists taken
+    from orbit_list_cache.
+
+    \ingroup libtensor_expr_btensor
+ **/
+class eval_plan_cache : public libutil::singleton<eval_plan_cache> {
+    friend class libutil::singleton<eval_plan_cache>;
+
+public:
+    typedef std::shared_ptr<const eval_plan> plan_ptr;
+
+private:
+    typedef std::list<std::string> lru_list;
+
+    struct entry {
+        plan_ptr plan; //!< Plan
+        lru_list::iterator pos; //!< Position in the LRU list
+    };
+
+    typedef std::unordered_map<std::string, entry> map_type;
+
+private:
+    libutil::mutex m_lock; //!< Protects the state below
+    map_type m_map; //!< Cached plans
+    lru_list m_lru; //!< Keys, most recently used first
+    size_t m_maxsize; //!< Max number of plans
+    size_t m_hits; //!< Number of hits
+    size_t m_misses; //!< Number of misses
+
+protected:
+    eval_plan_cache();
+
+public:
+    /** \brief Returns the cached plan for a key, or an empty pointer if
+            the key is not in the cache
+     **/
+    static plan_ptr lookup(const std::string &key);
+
+    /** \brief Stores a plan in the cache
+     **/
+    static void insert(const std::string &key, const plan_ptr &plan);
+
+    /** \brief Removes all the plans from the cache and resets the counters
+     **/
+    static void clear();
+
+    /** \brief Sets the maximum number of plans (zero disables the cache)
+     **/
+    static void set_max_size(size_t maxsize);
+    static size_t get_max_size();
+
+    /** \brief Returns the number of cached plans
+     **/
+    static size_t get_size();
+
+    static size_t get_hits();
+    static size_t get_misses();
+
+private:
+    void evict();
+
+};
+
+
+} // namespace expr
+} // namespace libtensor
+
+#endif // LIBTENSOR_EXPR_EVAL_PLAN_CACHE_H
@@ -1,7 +1,13 @@
 #ifndef LIBTENSOR_EXPR_EVAL_TREE_BUILDER_BTENSOR_H
 #define LIBTENSOR_EXPR_EVAL_TREE_BUILDER_BTENSOR_H
 
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
 #include <libtensor/expr/dag/expr_tree.h>
+#include "eval_plan_cache.h"
+#include "interm_pool.h"
 
 namespace libtensor {
 namespace expr {
@@ -12,6 +18,7 @@ public:
     static const char k_clazz[]; //!< Class name
 
     typedef std::vector<expr_tree::node_id_t> eval_order_t;
+    typedef std::vector<eval_order_t> dep_list_t;
 
 public:
     enum {
@@ -19,15 +26,26 @@ public:
     };
 
 private:
+    std::string m_key; //!< Key of the plan (empty if not cached)
+    std::vector<const node*> m_leaves; //!< Tensors and scalars of expression
+    eval_plan_cache::plan_ptr m_plan; //!< Cached plan
     expr_tree m_tree; //!< Evaluation tree
-    eval_order_t m_order;
+    eval_order_t m_order; //!< Order of evaluation
+    dep_list_t m_deps; //!< Earlier steps read by each step
+    std::set<expr_tree::node_id_t> m_direct; //!< Steps hinted as direct
+    std::shared_ptr<interm_pool> m_pool; //!< Pool of intermediates
 
 public:
-    eval_tree_builder_btensor(const expr_tree &tr) :
-        m_tree(tr), m_order(0)
-    { }
+    /** \brief Initializes the builder with an expression, which must not
+            be destroyed before the builder
+     **/
+    eval_tree_builder_btensor(const expr_tree &tr);
 
     /** \brief Modifies the expression tree for direct evaluation
+
+        The optimization passes only run the first time an expression is
+        built. The optimized tree is cached (see eval_plan_cache) and reused
+        for later expressions with the same operations and tensors.
      **/
     void build();
 
@@ -40,6 +58,34 @@ public:
     const eval_order_t &get_order() {
         return m_order;
     }
+
+    /** \brief Returns the earlier steps of the evaluation order whose
+            results are read by each step
+
+        The steps are given by the IDs of their assignment nodes. Once
+        evaluated, these nodes are replaced by their left-hand sides.
+     **/
+    const dep_list_t &get_deps() {
+        return m_deps;
+    }
+
+    /** \brief Returns the steps whose results were marked for direct
+            evaluation in the expression
+     **/
+    const std::set<expr_tree::node_id_t> &get_direct() {
+        return m_direct;
+    }
+
+    /** \brief Returns the pool of intermediates
+     **/
+    interm_pool &get_pool() {
+        return *m_pool;
+    }
+
+private:
+    static eval_plan_cache::plan_ptr find_plan(const expr_tree &tr,
+        std::string &key, std::vector<const node*> &leaves);
+    void save_plan();
 };
 
 
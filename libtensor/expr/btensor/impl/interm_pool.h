@@ -0,0 +1,179 @@
+#ifndef LIBTENSOR_EXPR_INTERM_POOL_H
+#define LIBTENSOR_EXPR_INTERM_POOL_H
+
+#include <list>
+#include <vector>
+#include <libutil/threads/auto_lock.h>
+#include <libutil/threads/mutex.h>
+#include <libtensor/core/abs_index.h>
+#include <libtensor/core/noncopyable.h>
+#include <libtensor/block_tensor/block_tensor_i_traits.h>
+#include <libtensor/gen_block_tensor/gen_block_tensor_ctrl.h>
+#include <libtensor/expr/btensor/btensor.h>
+
+namespace libtensor {
+namespace expr {
+
+
+/** \brief Pool of the intermediate block tensors of one expression
+
+    Intermediates are obtained from the pool using acquire() and returned
+    using release() when they are no longer needed. Released block tensors
+    are emptied right away, which returns the memory of their blocks to the
+    allocator, and their symmetry is cleared. The block tensor objects are
+    kept and handed out again to the next intermediate with the same block
+    index space, whatever its symmetry.
+
+    The pool also keeps track of the memory held by the blocks of live
+    intermediates: update() records the current footprint and its maximum
+    over the life of the pool.
+
+    All methods are thread-safe, intermediates of independent evaluation
+    steps may be acquired and released concurrently.
+
+    \ingroup libtensor_expr_btensor
+ **/
+class interm_pool : public noncopyable {
+private:
+    class holder_base {
+    public:
+        virtual ~holder_base() { }
+        virtual size_t get_bytes() const = 0;
+    };
+
+    template<size_t N, typename T>
+    class holder : public holder_base {
+    public:
+        btensor<N, T> *bt; //!< Block tensor
+
+    public:
+        holder(btensor<N, T> *bt_) : bt(bt_) { }
+        virtual ~holder() { delete bt; }
+        virtual size_t get_bytes() const;
+    };
+
+private:
+    std::list<holder_base*> m_live; //!< Intermediates in use
+    std::list<holder_base*> m_free; //!< Released intermediates
+    size_t m_bytes; //!< Current footprint (bytes)
+    size_t m_peak; //!< Peak footprint (bytes)
+    size_t m_nalloc; //!< Number of new intermediates
+    size_t m_nreuse; //!< Number of reused intermediates
+    libutil::mutex m_lock; //!< Mutex
+
+public:
+    interm_pool() :
+        m_bytes(0), m_peak(0), m_nalloc(0), m_nreuse(0)
+    { }
+
+    /** \brief Destroys all intermediates
+     **/
+    ~interm_pool();
+
+    /** \brief Returns an empty block tensor with the given block index space
+     **/
+    template<size_t N, typename T>
+    btensor<N, T> *acquire(const block_index_space<N> &bis);
+
+    /** \brief Empties a block tensor previously obtained from acquire(),
+            clears its symmetry and keeps it for reuse
+     **/
+    template<size_t N, typename T>
+    void release(btensor<N, T> *bt);
+
+    /** \brief Updates the current and peak memory footprint
+     **/
+    void update();
+
+    /** \brief Returns the peak footprint of intermediates in bytes
+     **/
+    size_t get_peak() const {
+        return m_peak;
+    }
+
+    /** \brief Returns the number of newly created intermediates
+     **/
+    size_t get_nalloc() const {
+        return m_nalloc;
+    }
+
+    /** \brief Returns the number of intermediates that reused a released
+            block tensor
+     **/
+    size_t get_nreuse() const {
+        return m_nreuse;
+    }
+
+};
+
+
+template<size_t N, typename T>
+size_t interm_pool::holder<N, T>::get_bytes() const {
+
+    typedef block_tensor_i_traits<T> bti_traits;
+
+    gen_block_tensor_rd_ctrl<N, bti_traits> ctrl(*bt);
+    std::vector<size_t> nzblk;
+    ctrl.req_nonzero_blocks(nzblk);
+
+    const block_index_space<N> &bis = bt->get_bis();
+    dimensions<N> bidims = bis.get_block_index_dims();
+    size_t sz = 0;
+    for(size_t i = 0; i < nzblk.size(); i++) {
+        index<N> bidx;
+        abs_index<N>::get_index(nzblk[i], bidims, bidx);
+        sz += bis.get_block_dims(bidx).get_size();
+    }
+    return sz * sizeof(T);
+}
+
+
+template<size_t N, typename T>
+btensor<N, T> *interm_pool::acquire(const block_index_space<N> &bis) {
+
+    libutil::auto_lock<libutil::mutex> lock(m_lock);
+
+    for(std::list<holder_base*>::iterator i = m_free.begin();
+        i != m_free.end(); ++i) {
+
+        holder<N, T> *h = dynamic_cast< holder<N, T>* >(*i);
+        if(h == 0 || !h->bt->get_bis().equals(bis)) continue;
+        m_live.splice(m_live.end(), m_free, i);
+        m_nreuse++;
+        return h->bt;
+    }
+
+    holder<N, T> *h = new holder<N, T>(new btensor<N, T>(bis));
+    m_live.push_back(h);
+    m_nalloc++;
+    return h->bt;
+}
+
+
+template<size_t N, typename T>
+void interm_pool::release(btensor<N, T> *bt) {
+
+    typedef block_tensor_i_traits<T> bti_traits;
+
+    libutil::auto_lock<libutil::mutex> lock(m_lock);
+
+    for(std::list<holder_base*>::iterator i = m_live.begin();
+        i != m_live.end(); ++i) {
+
+        holder<N, T> *h = dynamic_cast< holder<N, T>* >(*i);
+        if(h == 0 || h->bt != bt) continue;
+        {
+            gen_block_tensor_ctrl<N, bti_traits> ctrl(*bt);
+            ctrl.req_zero_all_blocks();
+            ctrl.req_symmetry().clear();
+        }
+        m_free.splice(m_free.end(), m_live, i);
+        return;
+    }
+}
+
+
+} // namespace expr
+} // namespace libtensor
+
+#endif // LIBTENSOR_EXPR_INTERM_POOL_H
@@ -2,6 +2,7 @@
 #define LIBTENSOR_EXPR_NODE_INTERM_H
 
 #include <map>
+#include <memory>
 #include <libtensor/expr/dag/node.h>
 #include "btensor_placeholder.h"
 
@@ -18,6 +19,11 @@ public:
     virtual ~node_interm_base() { }
 
     virtual const std::type_info &get_t() const = 0;
+
+    /** \brief Releases the intermediate tensor, which must not be used
+            afterwards
+     **/
+    virtual void release() const = 0;
 };
 
 
@@ -29,6 +35,8 @@ private:
         size_t cnt; //!< Counter
 
         counter() : cnt(1) { }
+        counter(const std::shared_ptr<interm_pool> &pool) :
+            bt(pool), cnt(1) { }
     };
     counter *m_cnt;
 
@@ -37,6 +45,11 @@ public:
         m_cnt = new counter();
     }
 
+    node_interm(const std::shared_ptr<interm_pool> &pool) :
+        node_interm_base(N) {
+        m_cnt = new counter(pool);
+    }
+
     node_interm(const node_interm<N, T> &other) : node_interm_base(N) {
         m_cnt = other.m_cnt;
         m_cnt->cnt++;
@@ -59,6 +72,10 @@ public:
         return m_cnt->bt;
     }
 
+    virtual void release() const {
+        m_cnt->bt.destroy_btensor();
+    }
+
 private:
     node_interm<N, T> &operator==(const node_interm<N, T> &);
 
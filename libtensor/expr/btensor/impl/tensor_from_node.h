@@ -25,6 +25,7 @@ public:
     }
 
     btensor_i<N, T> &get_btensor() const;
+    block_tensor_rd_i<N, T> &get_rd_btensor() const;
     btensor<N, T> &get_or_create_btensor(const block_index_space<N> &bis);
 
 };
@@ -61,7 +62,7 @@ btensor_i<N, T> &btensor_from_node<N, T>::get_btensor() const {
             n.template recast_as< node_interm<N, T> >();
         btensor_placeholder<N, T> &ph =
             btensor_placeholder<N, T>::from_any_tensor(ni.get_tensor());
-        if(ph.is_empty()) {
+        if(ph.is_empty() || ph.is_direct()) {
             throw eval_exception(__FILE__, __LINE__,
                 "libtensor::expr::eval_btensor_double",
                 "btensor_from_node<N, T>", "get_btensor()",
@@ -80,6 +81,24 @@ btensor_i<N, T> &btensor_from_node<N, T>::get_btensor() const {
 }
 
 
+template<size_t N, typename T>
+block_tensor_rd_i<N, T> &btensor_from_node<N, T>::get_rd_btensor() const {
+
+    const node &n = m_tree.get_vertex(m_leaf);
+
+    if(n.check_type<node_interm_base>()) {
+
+        const node_interm<N, T> &ni =
+            n.template recast_as< node_interm<N, T> >();
+        btensor_placeholder<N, T> &ph =
+            btensor_placeholder<N, T>::from_any_tensor(ni.get_tensor());
+        if(ph.is_direct()) return ph.get_rd_btensor();
+    }
+
+    return get_btensor();
+}
+
+
 template<size_t N, typename T>
 btensor<N, T> &btensor_from_node<N, T>::get_or_create_btensor(
     const block_index_space<N> &bis) {
@@ -0,0 +1,50 @@
+#ifndef LIBTENSOR_EXPR_NODE_DIRECT_H
+#define LIBTENSOR_EXPR_NODE_DIRECT_H
+
+#include "node.h"
+
+namespace libtensor {
+namespace expr {
+
+
+/** \brief Tensor expression node: hint to evaluate the subexpression directly
+
+    The node has one child, the subexpression. It does not change the
+    result, but asks the evaluator not to store the result of the
+    subexpression. Instead, its blocks are computed on the fly when they
+    are needed by the operation that uses it. Evaluators that do not
+    support direct evaluation may store the result as usual.
+
+    \sa node
+
+    \ingroup libtensor_expr_dag
+ **/
+class node_direct : public node {
+public:
+    static const char k_op_type[]; //!< Operation type
+
+public:
+    /** \brief Creates a direct evaluation node
+        \param n Tensor order
+     **/
+    node_direct(size_t n) :
+        node(k_op_type, n)
+    { }
+
+    /** \brief Virtual destructor
+     **/
+    virtual ~node_direct() { }
+
+    /** \brief Creates a copy of the node via new
+     **/
+    virtual node *clone() const {
+        return new node_direct(*this);
+    }
+
+};
+
+
+} // namespace expr
+} // namespace libtensor
+
+#endif // LIBTENSOR_EXPR_NODE_DIRECT_H
@@ -0,0 +1,30 @@
+#ifndef LIBTENSOR_EXPR_PRINT_NODE_KEY_H
+#define LIBTENSOR_EXPR_PRINT_NODE_KEY_H
+
+#include <iostream>
+#include "node.h"
+
+namespace libtensor {
+namespace expr {
+
+
+/** \brief Prints the operation and all the parameters of a node
+    \param n Node.
+    \param os Output stream.
+    \return False if the node is not known or refers to data outside of it.
+
+    Two nodes of known types that print the same key represent the same
+    operation. Nodes that refer to tensors or scalars (identities,
+    scalars, intermediates) are not printed since the key would not
+    identify the data.
+
+    \ingroup libtensor_expr_dag
+ **/
+bool print_node_key(const node &n, std::ostream &os);
+
+
+} // namespace expr
+} // namespace libtensor
+
+
+#endif // LIBTENSOR_EXPR_PRINT_NODE_KEY_H
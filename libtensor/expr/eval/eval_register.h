@@ -22,8 +22,11 @@ private:
 
 public:
     /** \brief Adds an evaluator to the list
+        \param e Evaluator.
+        \param first Whether the evaluator is tried before the ones already
+            in the list (default: after).
      **/
-    void add_evaluator(const eval_i &e);
+    void add_evaluator(const eval_i &e, bool first = false);
 
     /** \brief Removes an evaluator from the list
      **/
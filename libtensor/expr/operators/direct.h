@@ -0,0 +1,43 @@
+#ifndef LIBTENSOR_EXPR_OPERATORS_DIRECT_H
+#define LIBTENSOR_EXPR_OPERATORS_DIRECT_H
+
+#include <libtensor/expr/dag/node_direct.h>
+#include <libtensor/expr/iface/expr_rhs.h>
+
+namespace libtensor {
+namespace expr {
+
+
+/** \brief Marks a subexpression to be evaluated directly
+
+    The result of the subexpression is not stored. Its blocks are computed
+    when they are needed by the contraction that uses it and discarded
+    afterwards, which saves memory at the expense of recomputing blocks
+    that are used more than once. This is a hint, the evaluator may still
+    store the result if the subexpression is used otherwise.
+
+    \ingroup libtensor_expr_operators
+ **/
+template<size_t N, typename T>
+expr_rhs<N, T> direct(
+    const expr_rhs<N, T> &subexpr) {
+
+    node_direct ndirect(N);
+    expr_tree e(ndirect);
+    e.add(e.get_root(), subexpr.get_expr());
+
+    return expr_rhs<N, T>(e, subexpr.get_label());
+}
+
+
+} // namespace expr
+} // namespace libtensor
+
+
+namespace libtensor {
+
+using expr::direct;
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_EXPR_OPERATORS_DIRECT_H
@@ -7,6 +7,7 @@
 
 #include "contract.h"
 #include "diag.h"
+#include "direct.h"
 #include "dirsum.h"
 #include "dot_product.h"
 #include "ewmult.h"
@@ -0,0 +1,71 @@
+#ifndef LIBTENSOR_EXPR_OPT_CONTRACT_ORDER_H
+#define LIBTENSOR_EXPR_OPT_CONTRACT_ORDER_H
+
+#include <vector>
+#include <libtensor/expr/dag/graph.h>
+
+namespace libtensor {
+namespace expr {
+
+
+/** \brief Provides the sizes of tensors to opt_contract_order()
+
+    \ingroup libtensor_expr_opt
+ **/
+class opt_contract_order_info_i {
+public:
+    /** \brief Virtual destructor
+     **/
+    virtual ~opt_contract_order_info_i() { }
+
+    /** \brief Returns the maximum order of tensors that can be evaluated
+     **/
+    virtual size_t get_max_order() const = 0;
+
+    /** \brief Returns the dimensions and the density of the tensor
+            represented by a node
+        \param g Expression graph.
+        \param id Node ID.
+        \param[out] dims Dimensions of the tensor.
+        \param[out] density Fraction of elements stored in unique non-zero
+            blocks (0 to 1).
+        \return False if the information is not available for the node.
+     **/
+    virtual bool get_info(const graph &g, graph::node_id_t id,
+        std::vector<size_t> &dims, double &density) const = 0;
+
+};
+
+
+/** \brief Reorders chained contractions to minimize the operation count
+
+    This optimizer locates contraction nodes whose arguments are themselves
+    contractions, directly or via transformation nodes that are not shared
+    with other parts of the graph, as well as contractions of three or more
+    arguments:
+    ( C ( C E1 E2 ) E3 ) --> ( C E1 E2 E3 )
+    The resulting network of tensors E1 ... En is then evaluated as a
+    sequence of pairwise contractions chosen by dynamic programming over
+    subsets of the arguments. The cost of a pairwise contraction is the
+    product of the dimensions of all indexes involved scaled by the
+    densities of both arguments, which accounts for symmetry and zero
+    blocks. Among orders with the same cost the one with the smallest
+    largest intermediate is selected. The result is made to match the
+    original index order and scaling coefficient by a transformation node.
+
+    Contractions of two arguments that are already in the best order are
+    left unchanged. Contractions of three or more arguments are always
+    rewritten as pairwise contractions, in the order of arguments if the
+    sizes are not known. Intermediates of orders higher than allowed by
+    the info object are never formed.
+
+    \ingroup libtensor_expr_opt
+ **/
+void opt_contract_order(graph &g, const opt_contract_order_info_i &info);
+
+
+} // namespace expr
+} // namespace libtensor
+
+
+#endif // LIBTENSOR_EXPR_OPT_CONTRACT_ORDER_H
@@ -0,0 +1,32 @@
+#ifndef LIBTENSOR_EXPR_OPT_MERGE_EQUIV_SUBEXPR_H
+#define LIBTENSOR_EXPR_OPT_MERGE_EQUIV_SUBEXPR_H
+
+#include <libtensor/expr/dag/graph.h>
+
+namespace libtensor {
+namespace expr {
+
+
+/** \brief Merges equivalent subexpressions
+
+    This optimizer generalizes opt_merge_equiv_ident() to whole
+    subexpressions. Two nodes that represent the same operation (see
+    print_node_key()) on the same arguments are replaced by one node
+    shared by all the parents of either node. The merging proceeds from
+    the leaves upwards until no more equivalent nodes are found, so that
+    identical subtrees collapse into one:
+    ( + ( C A B ) ( * 2 ( C A B ) ) ) --> ( + X ( * 2 X ) ), X = ( C A B )
+
+    Identity leaves must be merged beforehand. Assignments and scalings
+    are never merged.
+
+    \ingroup libtensor_expr_opt
+ **/
+void opt_merge_equiv_subexpr(graph &g);
+
+
+} // namespace expr
+} // namespace libtensor
+
+
+#endif // LIBTENSOR_EXPR_OPT_MERGE_EQUIV_SUBEXPR_H
@@ -1,9 +1,15 @@
 #ifndef LIBTENSOR_GEN_BTO_CONTRACT2_H
 #define LIBTENSOR_GEN_BTO_CONTRACT2_H
 
+#include <memory>
+#include <vector>
+#include <libutil/threads/mutex.h>
 #include <libtensor/timings.h>
 #include <libtensor/core/contraction2.h>
 #include <libtensor/core/noncopyable.h>
+#include "impl/block_list.h"
+#include "impl/gen_bto_contract2_block_list.h"
+#include "impl/gen_bto_contract2_screen.h"
 #include "impl/gen_bto_contract2_sym.h"
 #include "assignment_schedule.h"
 #include "gen_block_stream_i.h"
@@ -84,6 +90,27 @@ private:
     scalar_transf<element_type> m_kc; //!< Scalar transform of the result.
     gen_bto_contract2_sym<N, M, K, Traits> m_symc; //!< Symmetry of the result
     assignment_schedule<NC, element_type> m_sch; //!< Assignment schedule
+    std::auto_ptr< gen_bto_contract2_screen<N, M, K, Traits> >
+        m_screen; //!< Screening of block contractions
+
+    /** \brief Non-zero blocks of the arguments, canonical and unfolded by
+            symmetry, and the block pairs that can be contracted
+     **/
+    struct block_lists {
+        block_list<NA> bla, blax; //!< Blocks of A
+        block_list<NB> blb, blbx; //!< Blocks of B
+        std::auto_ptr< gen_bto_contract2_block_list<N, M, K> > cbl; //!< Pairs
+
+        block_lists(const dimensions<NA> &bidimsa,
+            const std::vector<size_t> &blsta, const dimensions<NB> &bidimsb,
+            const std::vector<size_t> &blstb) :
+            bla(bidimsa, blsta), blax(bidimsa),
+            blb(bidimsb, blstb), blbx(bidimsb)
+        { }
+    };
+
+    std::auto_ptr<block_lists> m_blst; //!< Block lists (made on first use)
+    libutil::mutex m_blst_lock; //!< Protects m_blst
 
 public:
     /** \brief Initializes the contraction operation
@@ -135,6 +162,10 @@ public:
             the output tensor's symmetry
         \param trc Transformation to be applied to the computed block.
         \param[out] blkc Output tensor.
+
+        The lists of non-zero blocks of the arguments are made in the first
+        call and reused by later calls, so the arguments must not change
+        while the operation is in use.
      */
     void compute_block(
         bool zero,
@@ -142,8 +173,44 @@ public:
         const tensor_transf<NC, double> &trc,
         wr_block_type &blk);
 
+    /** \brief Estimates the cost of the contraction without computing it
+        \param[out] npairs Number of block contractions.
+        \param[out] nflops Number of floating-point operations.
+
+        Block contractions are listed for each canonical non-zero block of
+        the result using the non-zero blocks of the arguments, the data of
+        the arguments is not read.
+     **/
+    void get_cost(size_t &npairs, double &nflops);
+
+    /** \brief Enables screening of block contractions by block norms
+        \param thresh Threshold, zero turns screening off.
+
+        Block contractions whose product of the Frobenius norms of the
+        blocks, times the scaling coefficients, is below the threshold are
+        skipped by perform() and compute_block(). The norms of all the
+        blocks of the arguments are computed in this call. The schedule is
+        not affected, blocks of the result whose contractions have all been
+        skipped are zero. See gen_bto_contract2_screen for details.
+     **/
+    void set_screening(double thresh);
+
+    /** \brief Returns the block contractions skipped by screening so far
+        \param[out] npairs Number of skipped block contractions.
+        \param[out] nflops Floating-point operations of the skipped
+            contractions.
+        \param[out] err Upper bound for the resulting error of the
+            canonical blocks of the result in the Frobenius norm.
+     **/
+    void get_screening_stats(size_t &npairs, double &nflops,
+        double &err) const;
+
 private:
     void make_schedule();
+
+    /** \brief Returns the block lists, makes them on the first call
+     **/
+    const block_lists &get_block_lists();
 };
 
 
@@ -88,6 +88,20 @@ public:
     void perform(
         gen_block_stream_i<N, bti_traits> &out);
 
+    /** \brief Writes the blocks of the result to an output stream, each
+            canonical block is computed at once from the blocks of the
+            symmetrized operation
+        \param out Output stream.
+
+        Unlike perform(), which relays every block of the symmetrized
+        operation to all the blocks of the result it contributes to, this
+        method puts each block of the result exactly once. Blocks of the
+        symmetrized operation that contribute to several canonical blocks
+        are computed several times.
+     **/
+    void perform_blockwise(
+        gen_block_stream_i<N, bti_traits> &out);
+
     /** \brief Computes one block of the result
      **/
     void compute_block(
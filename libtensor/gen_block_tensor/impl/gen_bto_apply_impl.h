@@ -39,7 +39,9 @@ public:
         gen_block_stream_i<N, bti_traits> &out);
 
     virtual ~gen_bto_apply_task() { }
-    virtual unsigned long get_cost() const { return 0; }
+    virtual unsigned long get_cost() const {
+        return m_btb.get_bis().get_block_dims(m_idx).get_size();
+    }
     virtual void perform();
 
 };
@@ -0,0 +1,57 @@
+#ifndef LIBTENSOR_GEN_BTO_BLOCK_NORMS_H
+#define LIBTENSOR_GEN_BTO_BLOCK_NORMS_H
+
+#include <map>
+#include <libtensor/core/noncopyable.h>
+#include "../gen_block_tensor_i.h"
+
+namespace libtensor {
+
+
+/** \brief Table of the Frobenius norms of the non-zero blocks of a block
+        tensor
+    \tparam N Tensor order.
+    \tparam Traits Block tensor operation traits.
+
+    The norms are computed from the canonical blocks when build() is called
+    and stored for all the blocks of their orbits, non-canonical blocks
+    included. Later changes to the block tensor are not reflected. Blocks
+    that are not in the table are zero.
+
+    The traits class has to provide definitions for
+    - \c element_type -- Type of data elements
+    - \c bti_traits -- Type of block tensor interface traits class
+    - \c template to_dotprod_type<N>::type -- Type of tensor operation
+            to_dotprod
+
+    \ingroup libtensor_gen_bto
+ **/
+template<size_t N, typename Traits>
+class gen_bto_block_norms : public noncopyable {
+public:
+    typedef typename Traits::element_type element_type;
+    typedef typename Traits::bti_traits bti_traits;
+
+private:
+    std::map<size_t, double> m_norms; //!< Norms by absolute block index
+
+public:
+    /** \brief Computes the norms of the blocks of a block tensor
+        \param bt Block tensor.
+     **/
+    void build(gen_block_tensor_rd_i<N, bti_traits> &bt);
+
+    /** \brief Returns the norm of a block
+        \param aidx Absolute index of the block.
+     **/
+    double get_norm(size_t aidx) const {
+        std::map<size_t, double>::const_iterator i = m_norms.find(aidx);
+        return i == m_norms.end() ? 0.0 : i->second;
+    }
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_GEN_BTO_BLOCK_NORMS_H
@@ -0,0 +1,159 @@
+#ifndef LIBTENSOR_GEN_BTO_BLOCK_NORMS_IMPL_H
+#define LIBTENSOR_GEN_BTO_BLOCK_NORMS_IMPL_H
+
+#include <cmath>
+#include <vector>
+#include <libutil/threads/auto_lock.h>
+#include <libutil/threads/mutex.h>
+#include <libutil/thread_pool/thread_pool.h>
+#include <libtensor/core/abs_index.h>
+#include <libtensor/core/orbit.h>
+#include "../gen_block_tensor_ctrl.h"
+#include "gen_bto_block_norms.h"
+
+namespace libtensor {
+
+
+namespace {
+
+
+template<size_t N, typename Traits>
+class gen_bto_block_norms_task : public libutil::task_i {
+public:
+    typedef typename Traits::element_type element_type;
+    typedef typename Traits::bti_traits bti_traits;
+
+private:
+    gen_block_tensor_rd_i<N, bti_traits> &m_bt;
+    size_t m_aidx;
+    std::map<size_t, double> &m_norms;
+    libutil::mutex &m_mtx;
+
+public:
+    gen_bto_block_norms_task(
+        gen_block_tensor_rd_i<N, bti_traits> &bt,
+        size_t aidx,
+        std::map<size_t, double> &norms,
+        libutil::mutex &mtx) :
+
+        m_bt(bt), m_aidx(aidx), m_norms(norms), m_mtx(mtx)
+    { }
+
+    virtual ~gen_bto_block_norms_task() { }
+    virtual unsigned long get_cost() const { return 0; }
+    virtual void perform();
+
+};
+
+
+template<size_t N, typename Traits>
+class gen_bto_block_norms_task_iterator : public libutil::task_iterator_i {
+public:
+    typedef typename Traits::bti_traits bti_traits;
+
+private:
+    gen_block_tensor_rd_i<N, bti_traits> &m_bt;
+    const std::vector<size_t> &m_blst;
+    std::vector<size_t>::const_iterator m_i;
+    std::map<size_t, double> &m_norms;
+    libutil::mutex m_mtx;
+
+public:
+    gen_bto_block_norms_task_iterator(
+        gen_block_tensor_rd_i<N, bti_traits> &bt,
+        const std::vector<size_t> &blst,
+        std::map<size_t, double> &norms) :
+
+        m_bt(bt), m_blst(blst), m_i(m_blst.begin()), m_norms(norms)
+    { }
+
+    virtual bool has_more() const {
+        return m_i != m_blst.end();
+    }
+
+    virtual libutil::task_i *get_next() {
+        gen_bto_block_norms_task<N, Traits> *t =
+            new gen_bto_block_norms_task<N, Traits>(m_bt, *m_i, m_norms,
+                m_mtx);
+        ++m_i;
+        return t;
+    }
+
+};
+
+
+template<size_t N, typename Traits>
+class gen_bto_block_norms_task_observer : public libutil::task_observer_i {
+public:
+    virtual void notify_start_task(libutil::task_i *t) { }
+    virtual void notify_finish_task(libutil::task_i *t) { delete t; }
+
+};
+
+
+} // unnamed namespace
+
+
+template<size_t N, typename Traits>
+void gen_bto_block_norms<N, Traits>::build(
+    gen_block_tensor_rd_i<N, bti_traits> &bt) {
+
+    std::vector<size_t> blst;
+    {
+        gen_block_tensor_rd_ctrl<N, bti_traits> ctrl(bt);
+        ctrl.req_nonzero_blocks(blst);
+    }
+
+    m_norms.clear();
+    gen_bto_block_norms_task_iterator<N, Traits> ti(bt, blst, m_norms);
+    gen_bto_block_norms_task_observer<N, Traits> to;
+    libutil::thread_pool::submit(ti, to);
+}
+
+
+namespace {
+
+
+template<size_t N, typename Traits>
+void gen_bto_block_norms_task<N, Traits>::perform() {
+
+    typedef typename Traits::template to_dotprod_type<N>::type to_dotprod_type;
+    typedef typename bti_traits::template rd_block_type<N>::type rd_block_type;
+
+    gen_block_tensor_rd_ctrl<N, bti_traits> ctrl(m_bt);
+    const symmetry<N, element_type> &sym = ctrl.req_const_symmetry();
+
+    index<N> idx;
+    abs_index<N>::get_index(m_aidx, m_bt.get_bis().get_block_index_dims(),
+        idx);
+
+    element_type d;
+    {
+        tensor_transf<N, element_type> tr0;
+        rd_block_type &blk = ctrl.req_const_block(idx);
+        d = to_dotprod_type(blk, tr0, blk, tr0).calculate();
+        ctrl.ret_const_block(idx);
+    }
+    double norm = std::sqrt(std::abs(d));
+
+    //  Blocks in the orbit are copies of the canonical block up to the
+    //  scalar transformation
+
+    orbit<N, element_type> o(sym, m_aidx, false);
+    {
+        libutil::auto_lock<libutil::mutex> lock(m_mtx);
+        for(typename orbit<N, element_type>::iterator j = o.begin();
+            j != o.end(); ++j) {
+            m_norms[o.get_abs_index(j)] = norm *
+                std::abs(o.get_transf(j).get_scalar_tr().get_coeff());
+        }
+    }
+}
+
+
+} // unnamed namespace
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_GEN_BTO_BLOCK_NORMS_IMPL_H
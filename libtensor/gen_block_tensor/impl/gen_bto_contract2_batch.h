@@ -8,6 +8,7 @@
 #include "../gen_block_stream_i.h"
 #include "../gen_block_tensor_i.h"
 #include "gen_bto_contract2_block_list.h"
+#include "gen_bto_contract2_screen.h"
 
 namespace libtensor {
 
@@ -62,6 +63,7 @@ private:
     const std::vector<size_t> &m_batchb; //!< List of blocks in B
     block_index_space<NC> m_bisc; //!< Block index space of result (C)
     scalar_transf<element_type> m_kc; //!< Scalar transformation of C
+    gen_bto_contract2_screen<N, M, K, Traits> *m_screen; //!< Screening
 
 public:
     /** \brief Initializes the contraction operation
@@ -76,6 +78,7 @@ public:
         \param batchb List of blocks in B.
         \param bisc Block index space of result (C).
         \param kc Scalar transform of C.
+        \param screen Screening of block contractions (optional).
      **/
     gen_bto_contract2_batch(
         const contraction2<N, M, K> &contr,
@@ -92,7 +95,8 @@ public:
         const block_list<NB> &blbx,
         const std::vector<size_t> &batchb,
         const block_index_space<NC> &bisc,
-        const scalar_transf<element_type> &kc);
+        const scalar_transf<element_type> &kc,
+        gen_bto_contract2_screen<N, M, K, Traits> *screen = 0);
 
     /** \brief Computes and writes the blocks of the result to an output stream
         \param blst List of absolute indexes of canonical blocks to be computed.
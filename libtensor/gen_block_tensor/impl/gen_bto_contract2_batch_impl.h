@@ -3,7 +3,9 @@
 
 #include <algorithm>
 #include <utility>
+#include <libutil/thread_pool/lpt_task_iterator.h>
 #include <libutil/thread_pool/thread_pool.h>
+#include <libtensor/core/batching_policy_base.h>
 #include <libtensor/symmetry/so_permute.h>
 #include "../gen_block_tensor_ctrl.h"
 #include "../gen_bto_aux_copy.h"
@@ -11,6 +13,7 @@
 #include "gen_bto_contract2_block_impl.h"
 #include "gen_bto_contract2_block_list.h"
 #include "gen_bto_contract2_clst_builder.h"
+#include "gen_bto_contract2_screen_impl.h"
 #include "gen_bto_copy_impl.h"
 #include "gen_bto_unfold_block_list.h"
 #include "gen_bto_unfold_symmetry.h"
@@ -87,6 +90,7 @@ private:
     index<N + M> m_idxc;
     gen_block_stream_i<N + M, bti_traits> &m_out;
     unsigned long m_cost;
+    size_t m_key;
 
 public:
     gen_bto_contract2_task(
@@ -98,6 +102,7 @@ public:
 
     virtual ~gen_bto_contract2_task() { }
     virtual unsigned long get_cost() const { return m_cost; }
+    virtual size_t get_affinity() const { return m_key; }
     virtual void perform();
 
 };
@@ -163,12 +168,13 @@ gen_bto_contract2_batch<N, M, K, Traits, Timed>::gen_bto_contract2_batch(
     const block_list<NB> &blbx,
     const std::vector<size_t> &batchb,
     const block_index_space<NC> &bisc,
-    const scalar_transf<element_type> &kc) :
+    const scalar_transf<element_type> &kc,
+    gen_bto_contract2_screen<N, M, K, Traits> *screen) :
 
     m_contr(contr),
     m_bta(bta), m_bta2(bta2), m_perma(perma), m_ka(ka), m_blax(blax), m_batcha(batcha),
     m_btb(btb), m_btb2(btb2), m_permb(permb), m_kb(kb), m_blbx(blbx), m_batchb(batchb),
-    m_bisc(bisc), m_kc(kc) {
+    m_bisc(bisc), m_kc(kc), m_screen(screen) {
 
 }
 
@@ -250,30 +256,50 @@ void gen_bto_contract2_batch<N, M, K, Traits, Timed>::perform(
             gen_bto_contract2_task_observer<N, M, K> to;
             libutil::thread_pool::submit(ti, to);
         }
-        for(typename std::vector<clst_pair_type>::iterator i = clstb.begin();
-            i != clstb.end(); ++i) {
-            const contr_list &clst = i->second->get_clst();
-            for(typename contr_list::const_iterator j = clst.begin();
-                j != clst.end(); ++j) {
-                blsta.push_back(j->get_aindex_a());
-                blstb.push_back(j->get_aindex_b());
+        if(m_screen != 0) {
+            for(typename std::vector<clst_pair_type>::iterator i =
+                clstb.begin(); i != clstb.end(); ++i) {
+                i->second->screen(*m_screen, m_perma, m_permb);
             }
         }
-        std::sort(blsta.begin(), blsta.end());
-        blsta.resize(std::unique(blsta.begin(), blsta.end()) - blsta.begin());
-        std::sort(blstb.begin(), blstb.end());
-        blstb.resize(std::unique(blstb.begin(), blstb.end()) - blstb.begin());
 
-        gen_bto_unfold_symmetry<NA, Traits>().perform(syma2, blsta, m_bta2);
-        gen_bto_unfold_symmetry<NB, Traits>().perform(symb2, blstb, m_btb2);
+        //  Without unfolding, the batches keep only canonical blocks, which
+        //  are transformed in the contractions of blocks
+
+        bool unfold = batching_policy_base::get_unfold_symmetry();
+        if(unfold) {
+            for(typename std::vector<clst_pair_type>::iterator i =
+                clstb.begin(); i != clstb.end(); ++i) {
+                const contr_list &clst = i->second->get_clst();
+                for(typename contr_list::const_iterator j = clst.begin();
+                    j != clst.end(); ++j) {
+                    blsta.push_back(j->get_aindex_a());
+                    blstb.push_back(j->get_aindex_b());
+                }
+            }
+            std::sort(blsta.begin(), blsta.end());
+            blsta.resize(std::unique(blsta.begin(), blsta.end()) -
+                blsta.begin());
+            std::sort(blstb.begin(), blstb.end());
+            blstb.resize(std::unique(blstb.begin(), blstb.end()) -
+                blstb.begin());
+
+            gen_bto_unfold_symmetry<NA, Traits>().perform(syma2, blsta,
+                m_bta2);
+            gen_bto_unfold_symmetry<NB, Traits>().perform(symb2, blstb,
+                m_btb2);
+        }
 
         gen_bto_contract2_block<N, M, K, Traits, Timed> bto(m_contr,
             m_bta, m_bta2, syma2, bla, m_ka, m_btb, m_btb2, symb2, blb, m_kb,
-            m_bisc, m_kc);
+            m_bisc, m_kc, unfold);
         gen_bto_contract2_task_iterator<N, M, K, Traits, Timed> ti(bto, clstb,
             btc, out);
+        libutil::lpt_task_iterator lti(ti);
         gen_bto_contract2_task_observer<N, M, K> to;
-        libutil::thread_pool::submit(ti, to);
+        libutil::time_diff_t tail;
+        libutil::thread_pool::submit(lti, to, tail);
+        gen_bto_contract2_batch::add_time("tail", tail);
 
         for(typename std::vector<clst_pair_type>::iterator i = clstb.begin();
             i != clstb.end(); ++i) {
@@ -332,6 +358,10 @@ gen_bto_contract2_task<N, M, K, Traits, Timed>::gen_bto_contract2_task(
     m_bto(bto), m_clst(clst), m_btc(btc), m_idxc(idxc), m_out(out) {
 
     m_cost = m_bto.get_cost(m_clst, m_btc.get_bis(), m_idxc);
+
+    //  Blocks of C that start with the same block of A are likely to share
+    //  the blocks of A, so they are best computed by the same thread
+    m_key = m_clst.empty() ? 0 : m_clst.front().get_acindex_a() + 1;
 }
 
 
@@ -2,16 +2,32 @@
 #define LIBTENSOR_GEN_BTO_CONTRACT2_BATCHING_POLICY_H
 
 #include <algorithm>
+#include <vector>
+#include <libtensor/core/abs_index.h>
+#include <libtensor/core/block_index_space.h>
 #include <libtensor/core/contraction2.h>
 #include <libtensor/core/batching_policy_base.h>
 
 namespace libtensor {
 
 
-/** \brief Preliminary batching policy class for contraction of two tensors
+/** \brief Batching policy class for contraction of two tensors
 
-    TODO: Improve class and algorithms as soon as it is clear what the optimal
-    values for batching sizes are
+    The policy determines the number of blocks of A, B, and C that are
+    processed together in one batch by gen_bto_contract2. The batches of A
+    form the outer loop, the batches of B the middle loop and the batches of
+    C the inner loop. Thus A is read once, B is read once per batch of A,
+    and C is accumulated once per pair of batches of A and B.
+
+    If a memory budget is set via batching_policy_base::set_batch_memory()
+    and the sizes of the blocks are known, the batch sizes are chosen to
+    minimize the predicted I/O volume
+    \f[ V = S_A + n_A S_B + n_A n_B S_C \f]
+    where \f$ S_X \f$ is the total size of the non-zero blocks of X and
+    \f$ n_X \f$ the number of batches of X, subject to the constraint that
+    one batch of A, B, and C fits into the memory budget. Otherwise the
+    batch size from batching_policy_base::get_batch_size() is divided evenly
+    among A, B, and C.
 
     \ingroup libtensor_gen_bto
  **/
@@ -26,10 +42,12 @@ private:
 
 private:
     sequence<3, size_t> m_bsz; //!< Batch sizes
+    sequence<3, size_t> m_nblk; //!< Number of blocks
+    sequence<3, size_t> m_sz; //!< Total size of blocks (bytes)
 
 
 public:
-    /** \brief Constructs the batching data
+    /** \brief Constructs the batching data from block counts only
         \param contr Contraction
         \param nblka Number of blocks in A
         \param nblkb Number of blocks in B
@@ -38,9 +56,54 @@ public:
     gen_bto_contract2_batching_policy(const contraction2<N, M, K> &contr,
             size_t nblka, size_t nblkb, size_t nblkc);
 
+    /** \brief Constructs the batching data from the actual block sizes
+        \param contr Contraction
+        \param bisa Block index space of A
+        \param blsta List of non-zero blocks in A (absolute indexes)
+        \param bisb Block index space of B
+        \param blstb List of non-zero blocks in B (absolute indexes)
+        \param bisc Block index space of C
+        \param blstc List of non-zero blocks in C (absolute indexes)
+        \param szelem Size of one tensor element in bytes
+     **/
+    gen_bto_contract2_batching_policy(const contraction2<N, M, K> &contr,
+            const block_index_space<NA> &bisa,
+            const std::vector<size_t> &blsta,
+            const block_index_space<NB> &bisb,
+            const std::vector<size_t> &blstb,
+            const block_index_space<NC> &bisc,
+            const std::vector<size_t> &blstc,
+            size_t szelem);
+
     size_t get_bsz_a() { return m_bsz[0]; }
     size_t get_bsz_b() { return m_bsz[1]; }
     size_t get_bsz_c() { return m_bsz[2]; }
+
+    /** \brief Returns the predicted I/O volume in bytes for the chosen
+            batch sizes (zero if the block sizes are unknown)
+     **/
+    size_t get_io_volume() const;
+
+    /** \brief Returns the predicted memory required by one batch of A, B,
+            and C in bytes (zero if the block sizes are unknown)
+     **/
+    size_t get_batch_memory() const;
+
+private:
+    void make_fixed(size_t batch_size);
+    void make_optimal(size_t batch_mem);
+
+    static size_t get_nbat(size_t nblk, size_t bsz) {
+        return (nblk + bsz - 1) / bsz;
+    }
+
+    size_t get_avg(size_t i) const {
+        return m_nblk[i] > 0 ? (m_sz[i] + m_nblk[i] - 1) / m_nblk[i] : 0;
+    }
+
+    template<size_t NX>
+    static size_t get_size(const block_index_space<NX> &bis,
+        const std::vector<size_t> &blst, size_t szelem);
 };
 
 
@@ -49,24 +112,133 @@ gen_bto_contract2_batching_policy<N, M, K>::
 gen_bto_contract2_batching_policy(const contraction2<N, M, K> &contr,
     size_t nblka, size_t nblkb, size_t nblkc) {
 
-    size_t batch_size = batching_policy_base::get_batch_size();
-    //size_t nblktot = nblka + nblkb + nblkc;
-    size_t bsza, bszb, bszc;
-    size_t nbata, nbatb, nbatc;
-
-    //bsza = std::max(batch_size * nblka / nblktot, size_t(1));
-    //bszb = std::max(batch_size * nblkb / nblktot, size_t(1));
-    //bszc = std::max(batch_size * nblkc / nblktot, size_t(1));
-    bsza = std::max(std::min(batch_size / 3, nblka), size_t(1));
-    bszb = std::max(std::min(batch_size / 3, nblkb), size_t(1));
-    bszc = std::max(std::min(batch_size / 3, nblkc), size_t(1));
-
-    nbata = (nblka + bsza - 1) / bsza;
-    m_bsz[0] = (nbata > 0 ? (nblka + nbata - 1) / nbata : 1);
-    nbatb = (nblkb + bszb - 1) / bszb;
-    m_bsz[1] = (nbatb > 0 ? (nblkb + nbatb - 1) / nbatb : 1);
-    nbatc = (nblkc + bszc - 1) / bszc;
-    m_bsz[2] = (nbatc > 0 ? (nblkc + nbatc - 1) / nbatc : 1);
+    m_nblk[0] = nblka; m_nblk[1] = nblkb; m_nblk[2] = nblkc;
+    make_fixed(batching_policy_base::get_batch_size());
+}
+
+
+template<size_t N, size_t M, size_t K>
+gen_bto_contract2_batching_policy<N, M, K>::
+gen_bto_contract2_batching_policy(const contraction2<N, M, K> &contr,
+    const block_index_space<NA> &bisa, const std::vector<size_t> &blsta,
+    const block_index_space<NB> &bisb, const std::vector<size_t> &blstb,
+    const block_index_space<NC> &bisc, const std::vector<size_t> &blstc,
+    size_t szelem) {
+
+    m_nblk[0] = blsta.size();
+    m_nblk[1] = blstb.size();
+    m_nblk[2] = blstc.size();
+    m_sz[0] = get_size(bisa, blsta, szelem);
+    m_sz[1] = get_size(bisb, blstb, szelem);
+    m_sz[2] = get_size(bisc, blstc, szelem);
+
+    size_t batch_mem = batching_policy_base::get_batch_memory();
+    if(batch_mem > 0) make_optimal(batch_mem);
+    else make_fixed(batching_policy_base::get_batch_size());
+}
+
+
+template<size_t N, size_t M, size_t K>
+size_t gen_bto_contract2_batching_policy<N, M, K>::get_io_volume() const {
+
+    size_t nbata = get_nbat(m_nblk[0], m_bsz[0]);
+    size_t nbatb = get_nbat(m_nblk[1], m_bsz[1]);
+    return m_sz[0] + nbata * m_sz[1] + nbata * nbatb * m_sz[2];
+}
+
+
+template<size_t N, size_t M, size_t K>
+size_t gen_bto_contract2_batching_policy<N, M, K>::get_batch_memory() const {
+
+    return m_bsz[0] * get_avg(0) + m_bsz[1] * get_avg(1) +
+        m_bsz[2] * get_avg(2);
+}
+
+
+template<size_t N, size_t M, size_t K>
+void gen_bto_contract2_batching_policy<N, M, K>::make_fixed(
+    size_t batch_size) {
+
+    //  Divide the batch size evenly among A, B, and C, then balance
+    //  the batches so that all of them have approximately the same size
+
+    for(size_t i = 0; i < 3; i++) {
+        size_t bsz = std::max(std::min(batch_size / 3, m_nblk[i]), size_t(1));
+        size_t nbat = get_nbat(m_nblk[i], bsz);
+        m_bsz[i] = (nbat > 0 ? (m_nblk[i] + nbat - 1) / nbat : 1);
+    }
+}
+
+
+template<size_t N, size_t M, size_t K>
+void gen_bto_contract2_batching_policy<N, M, K>::make_optimal(
+    size_t batch_mem) {
+
+    size_t nblka = m_nblk[0], nblkb = m_nblk[1], nblkc = m_nblk[2];
+    size_t avga = std::max(get_avg(0), size_t(1));
+    size_t avgb = std::max(get_avg(1), size_t(1));
+    size_t avgc = std::max(get_avg(2), size_t(1));
+
+    //  Every batch of A leaves the remaining memory to one batch of B and
+    //  at least one block of C. For a given batch of A the volume is
+    //  minimal if the batch of B is as large as possible, so only
+    //  the numbers of batches of A need to be scanned.
+    //  The batch size of C does not affect the volume, C gets the rest.
+
+    bool found = false;
+    size_t bsza = 1, bszb = 1, vmin = 0;
+    for(size_t n = 1; n <= nblka; n++) {
+
+        size_t bsza1 = (nblka + n - 1) / n;
+        size_t nbata = get_nbat(nblka, bsza1);
+
+        size_t mema = bsza1 * avga;
+        if(mema + avgb + avgc <= batch_mem) {
+            size_t bszb1 = std::min((batch_mem - mema - avgc) / avgb, nblkb);
+            bszb1 = std::max(bszb1, size_t(1));
+            size_t nbatb = get_nbat(nblkb, bszb1);
+            size_t v = m_sz[0] + nbata * m_sz[1] + nbata * nbatb * m_sz[2];
+            if(!found || v < vmin) {
+                found = true;
+                vmin = v;
+                bsza = bsza1;
+                bszb = bszb1;
+            }
+        }
+    }
+
+    //  If not even one block of each fits into memory, fall back to
+    //  batches of one block
+
+    size_t memab = bsza * avga + bszb * avgb;
+    size_t bszc = memab < batch_mem ? (batch_mem - memab) / avgc : 1;
+    bszc = std::max(std::min(bszc, nblkc), size_t(1));
+
+    //  Balance batches
+
+    size_t bsz[3] = { bsza, bszb, bszc };
+    for(size_t i = 0; i < 3; i++) {
+        size_t nbat = get_nbat(m_nblk[i], bsz[i]);
+        m_bsz[i] = (nbat > 0 ? (m_nblk[i] + nbat - 1) / nbat : 1);
+    }
+}
+
+
+template<size_t N, size_t M, size_t K>
+template<size_t NX>
+size_t gen_bto_contract2_batching_policy<N, M, K>::get_size(
+    const block_index_space<NX> &bis, const std::vector<size_t> &blst,
+    size_t szelem) {
+
+    dimensions<NX> bidims = bis.get_block_index_dims();
+
+    size_t sz = 0;
+    for(size_t i = 0; i < blst.size(); i++) {
+        index<NX> idx;
+        abs_index<NX>::get_index(blst[i], bidims, idx);
+        sz += bis.get_block_dims(idx).get_size();
+    }
+    return sz * szelem;
 }
 
 
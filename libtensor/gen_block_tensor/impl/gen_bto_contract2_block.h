@@ -118,6 +118,9 @@ public:
         \param kb Scalar transform of B.
         \param bisc Block index space of result (C).
         \param kc Scalar transform of C.
+        \param unfolded Whether A and B with broken symmetry contain all
+            the non-zero blocks (unfolded symmetry) or only canonical blocks
+            of syma and symb.
      **/
     gen_bto_contract2_block(
         const contraction2<N, M, K> &contr,
@@ -132,7 +135,8 @@ public:
         const block_list<NB> &blb,
         const scalar_transf<element_type> &kb,
         const block_index_space<NC> &bisc,
-        const scalar_transf<element_type> &kc);
+        const scalar_transf<element_type> &kc,
+        bool unfolded = true);
 
     unsigned long get_cost(
         const contr_list_type &clst,
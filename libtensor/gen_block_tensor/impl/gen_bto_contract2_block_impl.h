@@ -47,7 +47,8 @@ gen_bto_contract2_block<N, M, K, Traits, Timed>::gen_bto_contract2_block(
     const block_list<NB> &blb,
     const scalar_transf<element_type> &kb,
     const block_index_space<NC> &bisc,
-    const scalar_transf<element_type> &kc) :
+    const scalar_transf<element_type> &kc,
+    bool unfolded) :
 
     m_contr(contr),
     m_bta(bta), m_bta2(bta2), m_bidimsa(m_bta2.get_bis().get_block_index_dims()),
@@ -55,7 +56,7 @@ gen_bto_contract2_block<N, M, K, Traits, Timed>::gen_bto_contract2_block(
     m_btb(btb), m_btb2(btb2), m_bidimsb(m_btb2.get_bis().get_block_index_dims()),
     m_symb(symb), m_blb(blb), m_kb(kb),
     m_bidimsc(bisc.get_block_index_dims()), m_kc(kc),
-    m_use_broken_sym(true) {
+    m_use_broken_sym(unfolded) {
 
 }
 
@@ -9,6 +9,7 @@
 #include "../gen_bto_contract2_clst.h"
 #include "block_list.h"
 #include "gen_bto_contract2_block_list.h"
+#include "gen_bto_contract2_screen.h"
 
 namespace libtensor {
 
@@ -73,6 +74,17 @@ public:
         return m_clst;
     }
 
+    /** \brief Removes the block contractions rejected by the screening
+            from the list
+        \param scr Screening.
+        \param perma Permutation of A applied to the block indexes.
+        \param permb Permutation of B applied to the block indexes.
+     **/
+    void screen(gen_bto_contract2_screen<N, M, K, Traits> &scr,
+        const permutation<NA> &perma, const permutation<NB> &permb) {
+        scr.perform(m_clst, perma, permb);
+    }
+
 protected:
     void coalesce(contr_list &clst);
     void merge(contr_list &clst);
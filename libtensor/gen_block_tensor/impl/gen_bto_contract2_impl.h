@@ -1,7 +1,9 @@
 #ifndef LIBTENSOR_GEN_BTO_CONTRACT2_IMPL_H
 #define LIBTENSOR_GEN_BTO_CONTRACT2_IMPL_H
 
+#include <cmath>
 #include <iterator>
+#include <libutil/threads/auto_lock.h>
 #include <libtensor/core/contraction2_align.h>
 #include <libtensor/core/short_orbit.h>
 #include <libtensor/symmetry/so_permute.h>
@@ -9,6 +11,7 @@
 #include "gen_bto_contract2_batching_policy.h"
 #include "gen_bto_contract2_clst_builder.h"
 #include "gen_bto_contract2_nzorb.h"
+#include "gen_bto_contract2_screen_impl.h"
 #include "gen_bto_contract2_sym_impl.h"
 #include "gen_bto_prefetch.h"
 #include "gen_bto_set_impl.h"
@@ -66,8 +69,14 @@ void gen_bto_contract2<N, M, K, Traits, Timed>::perform(
             cb.req_nonzero_blocks(blstb);
         }
 
-        size_t nblka = blsta.size(), nblkb = blstb.size(), nblkc = 0;
-        nblkc = std::distance(m_sch.begin(), m_sch.end());
+        std::vector<size_t> blstc;
+        for(typename assignment_schedule<NC, element_type>::iterator i =
+            m_sch.begin(); i != m_sch.end(); ++i) {
+            blstc.push_back(m_sch.get_abs_index(i));
+        }
+
+        size_t nblka = blsta.size(), nblkb = blstb.size(),
+            nblkc = blstc.size();
 
         //  Quit if either one of the arguments is zero
 
@@ -120,7 +129,8 @@ void gen_bto_contract2<N, M, K, Traits, Timed>::perform(
         dimensions<NC> bidimsct(bisct.get_block_index_dims());
 
         gen_bto_contract2_batching_policy<N, M, K> bp(m_contr,
-            nblka, nblkb, nblkc);
+            m_bta.get_bis(), blsta, m_btb.get_bis(), blstb,
+            m_symc.get_bis(), blstc, sizeof(element_type));
         size_t batchsza = bp.get_bsz_a(), batchszb = bp.get_bsz_b(),
             batchszc = bp.get_bsz_c();
 
@@ -198,8 +208,12 @@ void gen_bto_contract2<N, M, K, Traits, Timed>::perform(
             }
         }
 
-        gen_bto_prefetch<NA, Traits> prefetch_a(m_bta);
-        gen_bto_prefetch<NB, Traits> prefetch_b(m_btb);
+        //  The blocks of the next batches of A and B are prefetched in
+        //  the background while the current batch is computed
+
+        size_t maxmem = batching_policy_base::get_batch_memory();
+        gen_bto_prefetch<NA, Traits> prefetch_a(m_bta, maxmem);
+        gen_bto_prefetch<NB, Traits> prefetch_b(m_btb, maxmem);
 
         block_index_space<NA> bisa2(m_bta.get_bis());
         bisa2.permute(perma);
@@ -232,6 +246,7 @@ void gen_bto_contract2<N, M, K, Traits, Timed>::perform(
 
             const std::vector<size_t> &batcha = *iba1;
 
+            prefetch_a.wait();
             gen_bto_set_a_type(Traits::zero()).perform(bta2);
             {
                 tensor_transf<NA, element_type> tra(perma);
@@ -255,6 +270,7 @@ void gen_bto_contract2<N, M, K, Traits, Timed>::perform(
 
                 const std::vector<size_t> &batchb = *ibb1;
 
+                prefetch_b.wait();
                 gen_bto_set_b_type(Traits::zero()).perform(btb2);
                 {
                     tensor_transf<NB, element_type> trb(permb);
@@ -275,10 +291,10 @@ void gen_bto_contract2<N, M, K, Traits, Timed>::perform(
                 batch_iterator iba3 = iba2, ibb3 = ibb2;
                 ++iba3; ++ibb3;
                 if(ibb3 != fbatchesb.end()) {
-                    prefetch_b.perform(*ibb3);
-                } else {
-                    if(iba3 != fbatchesa.end()) prefetch_a.perform(*iba3);
-                    prefetch_b.perform(fbatchesb.front());
+                    prefetch_b.submit(*ibb3);
+                } else if(iba3 != fbatchesa.end()) {
+                    prefetch_a.submit(*iba3);
+                    prefetch_b.submit(fbatchesb.front());
                 }
 
                 for(batch_iterator ibc = batchesc.begin();
@@ -293,7 +309,8 @@ void gen_bto_contract2<N, M, K, Traits, Timed>::perform(
                     gen_bto_contract2_batch<N, M, K, Traits, Timed>(contr,
                         m_bta, bta2, perma, m_ka, blax, batcha,
                         m_btb, btb2, permb, m_kb, blbx, batchb,
-                        symct.get_bis(), m_kc).perform(batchc, out2);
+                        symct.get_bis(), m_kc, m_screen.get()).
+                        perform(batchc, out2);
                     out2.close();
                 }
             }
@@ -315,36 +332,153 @@ void gen_bto_contract2<N, M, K, Traits, Timed>::compute_block(
     const tensor_transf<NC, double> &trc,
     wr_block_type &blkc) {
 
-    dimensions<NA> bidimsa = m_bta.get_bis().get_block_index_dims();
-    dimensions<NB> bidimsb = m_btb.get_bis().get_block_index_dims();
     dimensions<NC> bidimsc = m_symc.get_bis().get_block_index_dims();
 
     gen_block_tensor_rd_ctrl<NA, bti_traits> ca(m_bta);
     gen_block_tensor_rd_ctrl<NB, bti_traits> cb(m_btb);
 
-    std::vector<size_t> blsta, blstb;
-    ca.req_nonzero_blocks(blsta);
-    cb.req_nonzero_blocks(blstb);
-    block_list<NA> bla(bidimsa, blsta), blax(bidimsa);
-    block_list<NB> blb(bidimsb, blstb), blbx(bidimsb);
-
     const symmetry<NA, element_type> &syma = ca.req_const_symmetry();
     const symmetry<NB, element_type> &symb = cb.req_const_symmetry();
 
-    gen_bto_unfold_block_list<NA, Traits>(syma, bla).build(blax);
-    gen_bto_unfold_block_list<NB, Traits>(symb, blb).build(blbx);
+    //  The block lists are the same for all the blocks of the result,
+    //  only the list of block pairs is made for each block
+    const block_lists &bl = get_block_lists();
 
     gen_bto_contract2_block<N, M, K, Traits, Timed> bto(m_contr, m_bta,
-        syma, bla, m_ka, m_btb, symb, blb, m_kb, m_symc.get_bis(), m_kc);
+        syma, bl.bla, m_ka, m_btb, symb, bl.blb, m_kb, m_symc.get_bis(), m_kc);
 
     gen_bto_contract2_clst_builder<N, M, K, Traits> clstop(m_contr,
-        syma, symb, blax, blbx, bidimsc, idxc);
-    clstop.build_list(false); // Build full contraction list
+        syma, symb, bl.blax, bl.blbx, bidimsc, idxc);
+    clstop.build_list(false, *bl.cbl); // Build full contraction list
+    if(m_screen.get() != 0) {
+        clstop.screen(*m_screen, permutation<NA>(), permutation<NB>());
+    }
 
     bto.compute_block(clstop.get_clst(), zero, idxc, trc, blkc);
 }
 
 
+template<size_t N, size_t M, size_t K, typename Traits, typename Timed>
+void gen_bto_contract2<N, M, K, Traits, Timed>::get_cost(size_t &npairs,
+    double &nflops) {
+
+    typedef typename gen_bto_contract2_clst<N, M, K, element_type>::list_type
+        contr_list;
+
+    const block_index_space<NA> &bisa = m_bta.get_bis();
+    const block_index_space<NC> &bisc = m_symc.get_bis();
+    dimensions<NA> bidimsa = bisa.get_block_index_dims();
+    dimensions<NC> bidimsc = bisc.get_block_index_dims();
+    const sequence<NA + NB + NC, size_t> &conn = m_contr.get_conn();
+
+    gen_block_tensor_rd_ctrl<NA, bti_traits> ca(m_bta);
+    gen_block_tensor_rd_ctrl<NB, bti_traits> cb(m_btb);
+
+    const symmetry<NA, element_type> &syma = ca.req_const_symmetry();
+    const symmetry<NB, element_type> &symb = cb.req_const_symmetry();
+
+    const block_lists &bl = get_block_lists();
+
+    npairs = 0;
+    nflops = 0.0;
+
+    for(typename assignment_schedule<NC, element_type>::iterator i =
+        m_sch.begin(); i != m_sch.end(); ++i) {
+
+        index<NC> idxc;
+        abs_index<NC>::get_index(m_sch.get_abs_index(i), bidimsc, idxc);
+        double szc = double(bisc.get_block_dims(idxc).get_size());
+
+        gen_bto_contract2_clst_builder<N, M, K, Traits> clstop(m_contr,
+            syma, symb, bl.blax, bl.blbx, bidimsc, idxc);
+        clstop.build_list(false, *bl.cbl);
+
+        const contr_list &clst = clstop.get_clst();
+        for(typename contr_list::const_iterator j = clst.begin();
+            j != clst.end(); ++j) {
+
+            index<NA> ia;
+            abs_index<NA>::get_index(j->get_aindex_a(), bidimsa, ia);
+            dimensions<NA> dimsa = bisa.get_block_dims(ia);
+            size_t szk = 1;
+            for(size_t k = 0; k < NA; k++) {
+                if(conn[NC + k] >= NA + NC) szk *= dimsa[k];
+            }
+            nflops += 2.0 * szc * double(szk);
+            npairs++;
+        }
+    }
+}
+
+
+template<size_t N, size_t M, size_t K, typename Traits, typename Timed>
+void gen_bto_contract2<N, M, K, Traits, Timed>::set_screening(double thresh) {
+
+    m_screen.reset();
+    if(thresh > 0.0) {
+        double k = std::abs(m_ka.get_coeff() * m_kb.get_coeff() *
+            m_kc.get_coeff());
+        m_screen.reset(new gen_bto_contract2_screen<N, M, K, Traits>(m_contr,
+            m_bta, m_btb, k, thresh));
+    }
+}
+
+
+template<size_t N, size_t M, size_t K, typename Traits, typename Timed>
+void gen_bto_contract2<N, M, K, Traits, Timed>::get_screening_stats(
+    size_t &npairs, double &nflops, double &err) const {
+
+    if(m_screen.get() != 0) {
+        npairs = m_screen->get_npairs();
+        nflops = m_screen->get_nflops();
+        err = m_screen->get_error();
+    } else {
+        npairs = 0;
+        nflops = 0.0;
+        err = 0.0;
+    }
+}
+
+
+template<size_t N, size_t M, size_t K, typename Traits, typename Timed>
+const typename gen_bto_contract2<N, M, K, Traits, Timed>::block_lists&
+gen_bto_contract2<N, M, K, Traits, Timed>::get_block_lists() {
+
+    {
+        libutil::auto_lock<libutil::mutex> lock(m_blst_lock);
+        if(m_blst.get() != 0) return *m_blst;
+    }
+
+    //  The lists are made without holding the lock: unfolding submits
+    //  tasks to the thread pool, which gives up the CPU to other tasks
+    //  that may be waiting for the lock. Threads that get here at the same
+    //  time make the lists more than once, the first ones are kept.
+
+    dimensions<NA> bidimsa = m_bta.get_bis().get_block_index_dims();
+    dimensions<NB> bidimsb = m_btb.get_bis().get_block_index_dims();
+
+    gen_block_tensor_rd_ctrl<NA, bti_traits> ca(m_bta);
+    gen_block_tensor_rd_ctrl<NB, bti_traits> cb(m_btb);
+
+    std::vector<size_t> blsta, blstb;
+    ca.req_nonzero_blocks(blsta);
+    cb.req_nonzero_blocks(blstb);
+
+    std::auto_ptr<block_lists> bl(
+        new block_lists(bidimsa, blsta, bidimsb, blstb));
+    gen_bto_unfold_block_list<NA, Traits>(ca.req_const_symmetry(),
+        bl->bla).build(bl->blax);
+    gen_bto_unfold_block_list<NB, Traits>(cb.req_const_symmetry(),
+        bl->blb).build(bl->blbx);
+    bl->cbl.reset(new gen_bto_contract2_block_list<N, M, K>(m_contr,
+        bidimsa, bl->blax, bidimsb, bl->blbx));
+
+    libutil::auto_lock<libutil::mutex> lock(m_blst_lock);
+    if(m_blst.get() == 0) m_blst = bl;
+    return *m_blst;
+}
+
+
 template<size_t N, size_t M, size_t K, typename Traits, typename Timed>
 void gen_bto_contract2<N, M, K, Traits, Timed>::make_schedule() {
 
@@ -0,0 +1,118 @@
+#ifndef LIBTENSOR_GEN_BTO_CONTRACT2_SCREEN_H
+#define LIBTENSOR_GEN_BTO_CONTRACT2_SCREEN_H
+
+#include <libutil/threads/mutex.h>
+#include <libtensor/core/contraction2.h>
+#include <libtensor/core/noncopyable.h>
+#include "../gen_block_tensor_i.h"
+#include "../gen_bto_contract2_clst.h"
+#include "gen_bto_block_norms.h"
+
+namespace libtensor {
+
+
+/** \brief Drops block contractions with small contributions to the result
+    \tparam N Order of first tensor less degree of contraction.
+    \tparam M Order of second tensor less degree of contraction.
+    \tparam K Order of contraction.
+    \tparam Traits Block tensor operation traits.
+
+    The Frobenius norm of the contraction of two blocks is bounded by the
+    product of the Frobenius norms of the blocks. Block contractions for
+    which this bound (including the scaling coefficients) is below the
+    threshold are removed from the lists of contractions. The norms of the
+    blocks of both arguments are computed once in the constructor
+    (\sa gen_bto_block_norms).
+
+    The number of dropped block contractions, their floating-point
+    operations, and the sum of their bounds are accumulated over all the
+    lists passed to perform(). The sum is an upper bound for the error of
+    the canonical blocks of the result in the Frobenius norm.
+
+    \sa gen_bto_contract2
+
+    \ingroup libtensor_gen_bto
+ **/
+template<size_t N, size_t M, size_t K, typename Traits>
+class gen_bto_contract2_screen : public noncopyable {
+public:
+    enum {
+        NA = N + K, //!< Order of first argument (A)
+        NB = M + K, //!< Order of second argument (B)
+        NC = N + M  //!< Order of result (C)
+    };
+
+public:
+    //! Type of tensor elements
+    typedef typename Traits::element_type element_type;
+
+    //! Block tensor interface traits
+    typedef typename Traits::bti_traits bti_traits;
+
+    //! Type of list of block contractions
+    typedef typename gen_bto_contract2_clst<N, M, K, element_type>::list_type
+        contr_list;
+
+private:
+    contraction2<N, M, K> m_contr; //!< Contraction
+    block_index_space<NA> m_bisa; //!< Block index space of A
+    block_index_space<NB> m_bisb; //!< Block index space of B
+    gen_bto_block_norms<NA, Traits> m_normsa; //!< Block norms of A
+    gen_bto_block_norms<NB, Traits> m_normsb; //!< Block norms of B
+    double m_k; //!< Absolute value of the product of scaling coefficients
+    double m_thresh; //!< Threshold
+    size_t m_npairs; //!< Number of dropped block contractions
+    double m_nflops; //!< Floating-point operations of dropped contractions
+    double m_err; //!< Sum of bounds of dropped contractions
+    libutil::mutex m_mtx; //!< Mutex
+
+public:
+    /** \brief Initializes the screening, computes the block norms
+        \param contr Contraction.
+        \param bta First argument (A).
+        \param btb Second argument (B).
+        \param k Absolute value of the product of scaling coefficients.
+        \param thresh Threshold.
+     **/
+    gen_bto_contract2_screen(
+        const contraction2<N, M, K> &contr,
+        gen_block_tensor_rd_i<NA, bti_traits> &bta,
+        gen_block_tensor_rd_i<NB, bti_traits> &btb,
+        double k,
+        double thresh);
+
+    /** \brief Removes the block contractions below the threshold from
+            the list (may be called concurrently)
+        \param clst List of block contractions.
+        \param perma Permutation of A applied to the block indexes in the list.
+        \param permb Permutation of B applied to the block indexes in the list.
+     **/
+    void perform(contr_list &clst, const permutation<NA> &perma,
+        const permutation<NB> &permb);
+
+    /** \brief Returns the number of dropped block contractions
+     **/
+    size_t get_npairs() const {
+        return m_npairs;
+    }
+
+    /** \brief Returns the floating-point operations of dropped block
+            contractions
+     **/
+    double get_nflops() const {
+        return m_nflops;
+    }
+
+    /** \brief Returns the bound for the error caused by the dropped block
+            contractions
+     **/
+    double get_error() const {
+        return m_err;
+    }
+
+};
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_GEN_BTO_CONTRACT2_SCREEN_H
@@ -0,0 +1,102 @@
+#ifndef LIBTENSOR_GEN_BTO_CONTRACT2_SCREEN_IMPL_H
+#define LIBTENSOR_GEN_BTO_CONTRACT2_SCREEN_IMPL_H
+
+#include <cmath>
+#include <libutil/threads/auto_lock.h>
+#include <libtensor/core/abs_index.h>
+#include "gen_bto_block_norms_impl.h"
+#include "gen_bto_contract2_screen.h"
+
+namespace libtensor {
+
+
+template<size_t N, size_t M, size_t K, typename Traits>
+gen_bto_contract2_screen<N, M, K, Traits>::gen_bto_contract2_screen(
+    const contraction2<N, M, K> &contr,
+    gen_block_tensor_rd_i<NA, bti_traits> &bta,
+    gen_block_tensor_rd_i<NB, bti_traits> &btb,
+    double k,
+    double thresh) :
+
+    m_contr(contr), m_bisa(bta.get_bis()), m_bisb(btb.get_bis()), m_k(k),
+    m_thresh(thresh), m_npairs(0), m_nflops(0.0), m_err(0.0) {
+
+    m_normsa.build(bta);
+    m_normsb.build(btb);
+}
+
+
+template<size_t N, size_t M, size_t K, typename Traits>
+void gen_bto_contract2_screen<N, M, K, Traits>::perform(contr_list &clst,
+    const permutation<NA> &perma, const permutation<NB> &permb) {
+
+    const sequence<NA + NB + NC, size_t> &conn = m_contr.get_conn();
+
+    permutation<NA> pinva(perma, true);
+    permutation<NB> pinvb(permb, true);
+    dimensions<NA> bidimsa(m_bisa.get_block_index_dims());
+    dimensions<NB> bidimsb(m_bisb.get_block_index_dims());
+    dimensions<NA> bidimsa2(bidimsa);
+    dimensions<NB> bidimsb2(bidimsb);
+    bidimsa2.permute(perma);
+    bidimsb2.permute(permb);
+
+    size_t npairs = 0;
+    double nflops = 0.0, err = 0.0;
+
+    typename contr_list::iterator i = clst.begin();
+    while(i != clst.end()) {
+
+        //  Norms of the blocks as they enter the contraction: canonical
+        //  block norm times the scalar transformation of the pair
+
+        index<NA> ia;
+        index<NB> ib;
+        abs_index<NA>::get_index(i->get_acindex_a(), bidimsa2, ia);
+        abs_index<NB>::get_index(i->get_acindex_b(), bidimsb2, ib);
+        ia.permute(pinva);
+        ib.permute(pinvb);
+        double na = m_normsa.get_norm(abs_index<NA>::get_abs_index(ia,
+            bidimsa)) * std::abs(i->get_transf_a().get_scalar_tr().get_coeff());
+        double nb = m_normsb.get_norm(abs_index<NB>::get_abs_index(ib,
+            bidimsb)) * std::abs(i->get_transf_b().get_scalar_tr().get_coeff());
+
+        double bound = m_k * na * nb;
+        if(bound >= m_thresh) {
+            ++i;
+            continue;
+        }
+
+        abs_index<NA>::get_index(i->get_aindex_a(), bidimsa2, ia);
+        abs_index<NB>::get_index(i->get_aindex_b(), bidimsb2, ib);
+        ia.permute(pinva);
+        ib.permute(pinvb);
+        dimensions<NA> dimsa = m_bisa.get_block_dims(ia);
+        dimensions<NB> dimsb = m_bisb.get_block_dims(ib);
+        double szi = 1.0, szj = 1.0, szk = 1.0;
+        for(size_t j = 0; j < NA; j++) {
+            if(conn[NC + j] >= NC + NA) szk *= double(dimsa[j]);
+            else szi *= double(dimsa[j]);
+        }
+        for(size_t j = 0; j < NB; j++) {
+            if(conn[NC + NA + j] < NC) szj *= double(dimsb[j]);
+        }
+
+        npairs++;
+        nflops += 2.0 * szi * szj * szk;
+        err += bound;
+        i = clst.erase(i);
+    }
+
+    if(npairs > 0) {
+        libutil::auto_lock<libutil::mutex> lock(m_mtx);
+        m_npairs += npairs;
+        m_nflops += nflops;
+        m_err += err;
+    }
+}
+
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_GEN_BTO_CONTRACT2_SCREEN_IMPL_H
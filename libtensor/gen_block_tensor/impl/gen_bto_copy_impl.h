@@ -39,7 +39,10 @@ public:
         gen_block_stream_i<N, bti_traits> &out);
 
     virtual ~gen_bto_full_copy_task() { }
-    virtual unsigned long get_cost() const { return 0; }
+    virtual unsigned long get_cost() const {
+        abs_index<N> aia(m_aia, m_bidimsa);
+        return m_bta.get_bis().get_block_dims(aia.get_index()).get_size();
+    }
     virtual void perform();
 
 };
@@ -69,7 +72,9 @@ public:
         gen_block_stream_i<N, bti_traits> &out);
 
     virtual ~gen_bto_part_copy_task() { }
-    virtual unsigned long get_cost() const { return 0; }
+    virtual unsigned long get_cost() const {
+        return m_symb.get_bis().get_block_dims(m_ib).get_size();
+    }
     virtual void perform();
 
 };
@@ -40,7 +40,9 @@ public:
         gen_block_stream_i<N + M + K, bti_traits> &out);
 
     virtual ~gen_bto_ewmult2_task() { }
-    virtual unsigned long get_cost() const { return 0; }
+    virtual unsigned long get_cost() const {
+        return m_btc.get_bis().get_block_dims(m_idx).get_size();
+    }
     virtual void perform();
 
 };
@@ -43,7 +43,9 @@ public:
         const scalar_transf<element_type> &c);
 
     virtual ~gen_bto_mult1_task() { }
-    virtual unsigned long get_cost() const { return 0; }
+    virtual unsigned long get_cost() const {
+        return m_bta.get_bis().get_block_dims(m_idxa).get_size();
+    }
     virtual void perform();
 
 };
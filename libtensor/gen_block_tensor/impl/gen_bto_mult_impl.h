@@ -42,7 +42,9 @@ public:
         gen_block_stream_i<N, bti_traits> &out);
 
     virtual ~gen_bto_mult_task() { }
-    virtual unsigned long get_cost() const { return 0; }
+    virtual unsigned long get_cost() const {
+        return m_btc.get_bis().get_block_dims(m_idx).get_size();
+    }
     virtual void perform();
 
 };
@@ -1,55 +1,275 @@
 #ifndef LIBTENSOR_GEN_BTO_PREFETCH_H
 #define LIBTENSOR_GEN_BTO_PREFETCH_H
 
+#include <deque>
+#include <memory>
 #include <vector>
+#include <libutil/threads/auto_lock.h>
+#include <libutil/threads/cond.h>
+#include <libutil/threads/mutex.h>
+#include <libutil/threads/thread.h>
+#include <libtensor/timings.h>
 #include <libtensor/core/abs_index.h>
+#include <libtensor/core/noncopyable.h>
 #include "../gen_block_tensor_i.h"
 #include "../gen_block_tensor_ctrl.h"
 
 namespace libtensor {
 
 
+/** \brief Prefetches blocks of a block tensor
+    \tparam N Tensor order.
+    \tparam Traits Block tensor operation traits.
+
+    perform() requests the prefetch of a list of blocks synchronously.
+
+    submit() queues a list of blocks to be prefetched by a background thread
+    while the calling thread continues to work. Before the prefetched
+    blocks are used, the caller waits for the queue to drain using wait().
+    The time spent waiting is recorded by the timer "stall", the time spent
+    by the background thread on prefetching by the timer "io". The amount of
+    I/O hidden behind computations is the difference of the two.
+
+    The number of bytes prefetched between two calls to wait() is limited by
+    the maximum given upon construction (zero for no limit). Blocks over
+    the limit are not prefetched, they will be read when they are used.
+    cancel() drops the queued requests and stops the one in progress.
+
+    \ingroup libtensor_gen_bto
+ **/
 template<size_t N, typename Traits>
-class gen_bto_prefetch {
+class gen_bto_prefetch :
+    public timings< gen_bto_prefetch<N, Traits> >, public noncopyable {
+
+    friend class timings< gen_bto_prefetch<N, Traits> >;
+
+public:
+    static const char k_clazz[]; //!< Class name
+
 public:
     typedef typename Traits::bti_traits bti_traits;
+    typedef typename Traits::element_type element_type;
+
+private:
+    class worker : public libutil::thread {
+    private:
+        gen_bto_prefetch &m_p;
+
+    public:
+        worker(gen_bto_prefetch &p) : m_p(p) { }
+        virtual void run() { m_p.run(); }
+    };
 
 private:
     gen_block_tensor_rd_i<N, bti_traits> &m_bt;
     dimensions<N> m_bidims;
+    size_t m_maxmem; //!< Max bytes prefetched between calls to wait()
+    std::auto_ptr<worker> m_worker; //!< Background thread
+    libutil::mutex m_lock; //!< Protects the state below
+    libutil::cond m_cwork; //!< Signals new work or stop to the worker
+    libutil::cond m_cdone; //!< Signals the worker going idle
+    std::deque< std::vector<size_t> > m_queue; //!< Queued requests
+    size_t m_inflight; //!< Bytes prefetched since last wait()
+    bool m_busy; //!< Whether the worker processes a request
+    bool m_cancel; //!< Cancel request in progress
+    bool m_stop; //!< Stop worker
 
 public:
-    gen_bto_prefetch(gen_block_tensor_rd_i<N, bti_traits> &bt) :
-        m_bt(bt), m_bidims(m_bt.get_bis().get_block_index_dims())
+    gen_bto_prefetch(gen_block_tensor_rd_i<N, bti_traits> &bt,
+        size_t maxmem = 0) :
+        m_bt(bt), m_bidims(m_bt.get_bis().get_block_index_dims()),
+        m_maxmem(maxmem), m_inflight(0), m_busy(false), m_cancel(false),
+        m_stop(false)
     { }
 
+    /** \brief Cancels the pending requests and stops the background thread
+     **/
+    ~gen_bto_prefetch();
+
+    /** \brief Prefetches a list of blocks synchronously
+     **/
     void perform(const std::vector<size_t> &blst);
 
+    /** \brief Queues a list of blocks for prefetching in the background
+     **/
+    void submit(const std::vector<size_t> &blst);
+
+    /** \brief Waits until all the queued requests are processed
+     **/
+    void wait();
+
+    /** \brief Drops all queued requests and waits for the one in progress
+            to stop
+     **/
+    void cancel();
+
+private:
+    void run();
+    bool prefetch_block(gen_block_tensor_rd_ctrl<N, bti_traits> &ctrl,
+        size_t aidx, bool limit);
+
 };
 
 
 template<size_t N, typename Traits>
-void gen_bto_prefetch<N, Traits>::perform(const std::vector<size_t> &blst) {
+const char gen_bto_prefetch<N, Traits>::k_clazz[] =
+    "gen_bto_prefetch<N, Traits>";
 
-    typedef typename bti_traits::template rd_block_type<N>::type rd_block_type;
-    typedef typename Traits::template to_copy_type<N>::type to_copy;
+
+template<size_t N, typename Traits>
+gen_bto_prefetch<N, Traits>::~gen_bto_prefetch() {
+
+    if(m_worker.get() == 0) return;
+
+    {
+        libutil::auto_lock<libutil::mutex> lock(m_lock);
+        m_queue.clear();
+        m_cancel = true;
+        m_stop = true;
+    }
+    m_cwork.signal();
+    m_worker->join();
+}
+
+
+template<size_t N, typename Traits>
+void gen_bto_prefetch<N, Traits>::perform(const std::vector<size_t> &blst) {
 
     gen_block_tensor_rd_ctrl<N, bti_traits> ctrl(m_bt);
 
     for(typename std::vector<size_t>::const_iterator i = blst.begin();
         i != blst.end(); ++i) {
+        prefetch_block(ctrl, *i, false);
+    }
+}
 
-        index<N> bidx;
-        abs_index<N>::get_index(*i, m_bidims, bidx);
 
-        rd_block_type &blk = ctrl.req_const_block(bidx);
+template<size_t N, typename Traits>
+void gen_bto_prefetch<N, Traits>::submit(const std::vector<size_t> &blst) {
+
+    if(blst.empty()) return;
+
+    {
+        libutil::auto_lock<libutil::mutex> lock(m_lock);
+        m_queue.push_back(blst);
+    }
+    if(m_worker.get() == 0) {
+        m_worker.reset(new worker(*this));
+        m_worker->start();
+    }
+    m_cwork.signal();
+}
+
+
+template<size_t N, typename Traits>
+void gen_bto_prefetch<N, Traits>::wait() {
+
+    if(m_worker.get() != 0) {
+        gen_bto_prefetch::start_timer("stall");
+        while(true) {
+            {
+                libutil::auto_lock<libutil::mutex> lock(m_lock);
+                if(m_queue.empty() && !m_busy) break;
+            }
+            m_cdone.wait();
+        }
+        gen_bto_prefetch::stop_timer("stall");
+    }
+
+    libutil::auto_lock<libutil::mutex> lock(m_lock);
+    m_inflight = 0;
+    m_cancel = false;
+}
+
+
+template<size_t N, typename Traits>
+void gen_bto_prefetch<N, Traits>::cancel() {
+
+    {
+        libutil::auto_lock<libutil::mutex> lock(m_lock);
+        m_queue.clear();
+        m_cancel = true;
+    }
+    wait();
+}
+
+
+template<size_t N, typename Traits>
+void gen_bto_prefetch<N, Traits>::run() {
+
+    gen_block_tensor_rd_ctrl<N, bti_traits> ctrl(m_bt);
+
+    while(true) {
+
+        std::vector<size_t> blst;
+        {
+            libutil::auto_lock<libutil::mutex> lock(m_lock);
+            if(m_stop) break;
+            if(!m_queue.empty()) {
+                blst.swap(m_queue.front());
+                m_queue.pop_front();
+                m_busy = true;
+            }
+        }
+        if(!m_busy) {
+            m_cwork.wait();
+            continue;
+        }
+
+        gen_bto_prefetch::start_timer("io");
+        try {
+            for(size_t i = 0; i < blst.size(); i++) {
+                {
+                    libutil::auto_lock<libutil::mutex> lock(m_lock);
+                    if(m_cancel) break;
+                }
+                if(!prefetch_block(ctrl, blst[i], true)) break;
+            }
+        } catch(...) {
+            //  Prefetching is only a hint, the blocks will be read
+            //  again when they are used
+        }
+        gen_bto_prefetch::stop_timer("io");
+
+        {
+            libutil::auto_lock<libutil::mutex> lock(m_lock);
+            m_busy = false;
+        }
+        m_cdone.signal();
+    }
+}
+
+
+template<size_t N, typename Traits>
+bool gen_bto_prefetch<N, Traits>::prefetch_block(
+    gen_block_tensor_rd_ctrl<N, bti_traits> &ctrl, size_t aidx, bool limit) {
+
+    typedef typename bti_traits::template rd_block_type<N>::type rd_block_type;
+    typedef typename Traits::template to_copy_type<N>::type to_copy;
+
+    index<N> bidx;
+    abs_index<N>::get_index(aidx, m_bidims, bidx);
+
+    if(limit && m_maxmem > 0) {
+        size_t sz = m_bt.get_bis().get_block_dims(bidx).get_size() *
+            sizeof(element_type);
+        libutil::auto_lock<libutil::mutex> lock(m_lock);
+        if(m_inflight + sz > m_maxmem) return false;
+        m_inflight += sz;
+    }
+
+    rd_block_type &blk = ctrl.req_const_block(bidx);
+    try {
         to_copy(blk).prefetch();
+    } catch(...) {
         ctrl.ret_const_block(bidx);
+        throw;
     }
+    ctrl.ret_const_block(bidx);
+    return true;
 }
 
 
 } // namespace libtensor
 
 #endif // LIBTENSOR_GEN_BTO_PREFETCH_H
-
@@ -2,6 +2,7 @@
 #define LIBTENSOR_GEN_BTO_SYMMETRIZE2_IMPL_H
 
 #include <list>
+#include <libutil/thread_pool/thread_pool.h>
 #include <libtensor/core/orbit.h>
 #include <libtensor/core/short_orbit.h>
 #include <libtensor/symmetry/so_symmetrize.h>
@@ -11,6 +12,90 @@
 namespace libtensor {
 
 
+template<size_t N, typename Traits, typename Timed>
+class gen_bto_symmetrize2_task : public libutil::task_i {
+public:
+    typedef typename Traits::element_type element_type;
+    typedef typename Traits::bti_traits bti_traits;
+
+private:
+    gen_bto_symmetrize2<N, Traits, Timed> &m_op;
+    index<N> m_ib;
+    gen_block_stream_i<N, bti_traits> &m_out;
+
+public:
+    gen_bto_symmetrize2_task(
+        gen_bto_symmetrize2<N, Traits, Timed> &op,
+        const index<N> &ib,
+        gen_block_stream_i<N, bti_traits> &out) :
+        m_op(op), m_ib(ib), m_out(out)
+    { }
+
+    virtual ~gen_bto_symmetrize2_task() { }
+    virtual unsigned long get_cost() const {
+        return m_op.get_bis().get_block_dims(m_ib).get_size();
+    }
+    virtual void perform();
+
+};
+
+
+template<size_t N, typename Traits, typename Timed>
+class gen_bto_symmetrize2_task_iterator : public libutil::task_iterator_i {
+public:
+    typedef typename Traits::element_type element_type;
+    typedef typename Traits::bti_traits bti_traits;
+
+private:
+    gen_bto_symmetrize2<N, Traits, Timed> &m_op;
+    gen_block_stream_i<N, bti_traits> &m_out;
+    const assignment_schedule<N, element_type> &m_sch;
+    dimensions<N> m_bidims;
+    typename assignment_schedule<N, element_type>::iterator m_i;
+
+public:
+    gen_bto_symmetrize2_task_iterator(
+        gen_bto_symmetrize2<N, Traits, Timed> &op,
+        gen_block_stream_i<N, bti_traits> &out) :
+        m_op(op), m_out(out), m_sch(m_op.get_schedule()),
+        m_bidims(m_op.get_bis().get_block_index_dims()), m_i(m_sch.begin())
+    { }
+
+    virtual bool has_more() const {
+        return m_i != m_sch.end();
+    }
+
+    virtual libutil::task_i *get_next() {
+        index<N> ib;
+        abs_index<N>::get_index(m_sch.get_abs_index(m_i), m_bidims, ib);
+        ++m_i;
+        return new gen_bto_symmetrize2_task<N, Traits, Timed>(m_op, ib, m_out);
+    }
+
+};
+
+
+template<size_t N, typename Traits, typename Timed>
+class gen_bto_symmetrize2_task_observer : public libutil::task_observer_i {
+public:
+    virtual void notify_start_task(libutil::task_i *t) { }
+    virtual void notify_finish_task(libutil::task_i *t) { delete t; }
+
+};
+
+
+template<size_t N, typename Traits, typename Timed>
+void gen_bto_symmetrize2_task<N, Traits, Timed>::perform() {
+
+    typedef typename Traits::template temp_block_type<N>::type temp_block_type;
+
+    tensor_transf<N, element_type> tr0;
+    temp_block_type blk(m_op.get_bis().get_block_dims(m_ib));
+    m_op.compute_block(true, m_ib, tr0, blk);
+    m_out.put(m_ib, blk, tr0);
+}
+
+
 template<size_t N, typename Traits, typename Timed>
 const char gen_bto_symmetrize2<N, Traits, Timed>::k_clazz[] =
     "gen_bto_symmetrize2<N, Traits, Timed>";
@@ -65,6 +150,27 @@ void gen_bto_symmetrize2<N, Traits, Timed>::perform(
 }
 
 
+template<size_t N, typename Traits, typename Timed>
+void gen_bto_symmetrize2<N, Traits, Timed>::perform_blockwise(
+    gen_block_stream_i<N, bti_traits> &out) {
+
+    gen_bto_symmetrize2::start_timer("perform_blockwise");
+
+    try {
+
+        gen_bto_symmetrize2_task_iterator<N, Traits, Timed> ti(*this, out);
+        gen_bto_symmetrize2_task_observer<N, Traits, Timed> to;
+        libutil::thread_pool::submit(ti, to);
+
+    } catch(...) {
+        gen_bto_symmetrize2::stop_timer("perform_blockwise");
+        throw;
+    }
+
+    gen_bto_symmetrize2::stop_timer("perform_blockwise");
+}
+
+
 template<size_t N, typename Traits, typename Timed>
 void gen_bto_symmetrize2<N, Traits, Timed>::compute_block(
     bool zero,
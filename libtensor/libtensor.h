@@ -40,6 +40,7 @@
 
 #include "expr/bispace/bispace.h"
 #include "expr/btensor/btensor.h"
+#include "expr/btensor/eval_btensor_dryrun.h"
 #include "expr/iface/expr_tensor.h"
 #include "expr/operators/operators.h"
 
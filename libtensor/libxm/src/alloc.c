@@ -42,12 +42,16 @@
 /* Pagefile growth when no more space is available. */
 #define XM_GROW_SIZE (256ULL * 1024 * 1024 * 1024)
 
+/* Address space reserved for the mapping of the pagefile. */
+#define XM_MAP_RESERVE (16ULL * 1024 * 1024 * 1024 * 1024)
+
 struct xm_allocator {
 	int fd;
 	int mpirank;
 	char *path;
 	size_t file_bytes;
 	unsigned char *pages;
+	char *map;
 #ifdef _OPENMP
 	omp_lock_t mutex;
 #endif
@@ -74,11 +78,33 @@ get_block_npages(uint64_t data_ptr)
 	return (data_ptr >> 32);
 }
 
+/* Map the part of the pagefile starting at offset into the reserved
+ * address space right after the part that is already mapped. */
+static int
+map_file(xm_allocator_t *allocator, size_t offset)
+{
+	void *p;
+
+	if (allocator->file_bytes > XM_MAP_RESERVE) {
+		fprintf(stderr, "map_file: pagefile exceeds reserved space\n");
+		return (1);
+	}
+	p = mmap(allocator->map + offset, allocator->file_bytes - offset,
+	    PROT_READ|PROT_WRITE, MAP_SHARED|MAP_FIXED, allocator->fd,
+	    (off_t)offset);
+	if (p == MAP_FAILED) {
+		perror("mmap");
+		return (1);
+	}
+	return (0);
+}
+
 static int
 extend_file(xm_allocator_t *allocator)
 {
-	size_t oldsize, newsize;
+	size_t oldsize, newsize, oldbytes;
 
+	oldbytes = allocator->file_bytes;
 	oldsize = allocator->file_bytes / XM_PAGE_SIZE / 8;
 	if (allocator->file_bytes % (XM_PAGE_SIZE * 8))
 		oldsize++;
@@ -93,6 +119,8 @@ extend_file(xm_allocator_t *allocator)
 		perror("ftruncate");
 		return (1);
 	}
+	if (allocator->map && map_file(allocator, oldbytes))
+		return (1);
 	if ((allocator->pages = realloc(allocator->pages, newsize)) == NULL) {
 		perror("realloc");
 		return (1);
@@ -144,8 +172,8 @@ allocate_pages(xm_allocator_t *allocator, size_t size_bytes)
 	return (ptr);
 }
 
-xm_allocator_t *
-xm_allocator_create(const char *path)
+static xm_allocator_t *
+create_allocator(const char *path, int mapped)
 {
 	xm_allocator_t *allocator;
 
@@ -200,18 +228,84 @@ xm_allocator_create(const char *path)
 			return (NULL);
 		}
 	}
+#ifndef XM_USE_MPI
+	/* The file is only mapped in the single-process case because
+	 * mappings are not coherent across nodes. */
+	if (path && mapped) {
+		void *p = mmap(NULL, XM_MAP_RESERVE, PROT_NONE,
+		    MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+		if (p == MAP_FAILED) {
+			perror("mmap");
+		} else {
+			allocator->map = p;
+			if (map_file(allocator, 0)) {
+				if (munmap(allocator->map, XM_MAP_RESERVE))
+					perror("munmap");
+				allocator->map = NULL;
+			}
+		}
+	}
+#else
+	(void)mapped;
+#endif
 #ifdef _OPENMP
 	omp_init_lock(&allocator->mutex);
 #endif
 	return (allocator);
 }
 
+xm_allocator_t *
+xm_allocator_create(const char *path)
+{
+	return (create_allocator(path, 0));
+}
+
+xm_allocator_t *
+xm_allocator_create_mapped(const char *path)
+{
+	return (create_allocator(path, 1));
+}
+
 const char *
 xm_allocator_get_path(xm_allocator_t *allocator)
 {
 	return (allocator->path);
 }
 
+void *
+xm_allocator_get_data(xm_allocator_t *allocator, uint64_t data_ptr)
+{
+	if (data_ptr == XM_NULL_PTR)
+		return (NULL);
+	if (allocator->path == NULL)
+		return ((void *)data_ptr);
+	if (allocator->map == NULL)
+		return (NULL);
+	return (allocator->map + get_block_offset(data_ptr));
+}
+
+void
+xm_allocator_prefetch(xm_allocator_t *allocator, uint64_t data_ptr,
+    size_t size_bytes)
+{
+	size_t offset;
+
+	if (data_ptr == XM_NULL_PTR || allocator->path == NULL ||
+	    size_bytes == 0)
+		return;
+	offset = get_block_offset(data_ptr);
+	if (allocator->map) {
+		if (madvise(allocator->map + offset, size_bytes,
+		    MADV_WILLNEED))
+			perror("madvise");
+	} else {
+#ifdef POSIX_FADV_WILLNEED
+		(void)posix_fadvise(allocator->fd, (off_t)offset,
+		    (off_t)size_bytes, POSIX_FADV_WILLNEED);
+#endif
+	}
+}
+
 uint64_t
 xm_allocator_allocate(xm_allocator_t *allocator, size_t size_bytes)
 {
@@ -262,6 +356,11 @@ xm_allocator_read(xm_allocator_t *allocator, uint64_t data_ptr,
 		memcpy(mem, (const void *)data_ptr, size_bytes);
 		return;
 	}
+	if (allocator->map) {
+		memcpy(mem, allocator->map + get_block_offset(data_ptr),
+		    size_bytes);
+		return;
+	}
 	offset = (off_t)get_block_offset(data_ptr);
 	while (size_bytes > 0) {
 		size_t size = size_bytes > MAXSIZE ? MAXSIZE : size_bytes;
@@ -287,6 +386,11 @@ xm_allocator_write(xm_allocator_t *allocator, uint64_t data_ptr,
 		memcpy((void *)data_ptr, mem, size_bytes);
 		return;
 	}
+	if (allocator->map) {
+		memcpy(allocator->map + get_block_offset(data_ptr), mem,
+		    size_bytes);
+		return;
+	}
 	offset = (off_t)get_block_offset(data_ptr);
 	while (size_bytes > 0) {
 		size_t size = size_bytes > MAXSIZE ? MAXSIZE : size_bytes;
@@ -330,6 +434,10 @@ xm_allocator_destroy(xm_allocator_t *allocator)
 {
 	if (allocator == NULL)
 		return;
+	if (allocator->map) {
+		if (munmap(allocator->map, XM_MAP_RESERVE))
+			perror("munmap");
+	}
 	if (allocator->mpirank == 0) {
 		if (allocator->path) {
 			if (close(allocator->fd))
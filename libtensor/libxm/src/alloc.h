@@ -40,11 +40,36 @@ typedef struct xm_allocator xm_allocator_t;
  *  \return New instance of ::xm_allocator_t. */
 xm_allocator_t *xm_allocator_create(const char *path);
 
+/** Create a disk-backed allocator which maps the file specified by \p path
+ *  into memory instead of moving the data through explicit reads and writes.
+ *  Data can then be accessed in place using xm_allocator_get_data. Falls back
+ *  to the behavior of xm_allocator_create if the file cannot be mapped or
+ *  when using MPI.
+ *  \param path Path to file backing the allocator.
+ *  \return New instance of ::xm_allocator_t. */
+xm_allocator_t *xm_allocator_create_mapped(const char *path);
+
 /** Return path to the file backing this allocator.
  *  \param allocator An allocator.
  *  \return File path or NULL if the \p allocator is backed by RAM. */
 const char *xm_allocator_get_path(xm_allocator_t *allocator);
 
+/** Return a direct pointer to the data. This is only possible if the data
+ *  is stored in RAM or the allocator maps its file into memory.
+ *  \param allocator An allocator.
+ *  \param data_ptr Data pointer.
+ *  \return Pointer to the data or NULL if the data cannot be accessed
+ *  directly. */
+void *xm_allocator_get_data(xm_allocator_t *allocator, uint64_t data_ptr);
+
+/** Advise the allocator that the data will be accessed soon so that it can
+ *  be read ahead from disk.
+ *  \param allocator An allocator.
+ *  \param data_ptr Data pointer.
+ *  \param size_bytes Size of data in bytes. */
+void xm_allocator_prefetch(xm_allocator_t *allocator, uint64_t data_ptr,
+    size_t size_bytes);
+
 /** Allocate storage of the specified size from this allocator. This function
  *  returns \p data_ptr handle which is used by other allocator functions.
  *  \param allocator An allocator.
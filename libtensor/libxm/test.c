@@ -1958,6 +1958,41 @@ static const struct contract_test contract_tests[] = {
 	{ make_abc_12, "afcb", "bace", "fe" },
 };
 
+static void
+test_alloc_mapped(const char *path)
+{
+	xm_allocator_t *allocator;
+	uint64_t ptr[8];
+	double *data, buf[16];
+	size_t i, j, n = 1024 * 1024;
+
+	allocator = xm_allocator_create_mapped(path);
+	assert(allocator);
+	if (xm_allocator_get_data(allocator, 0) == NULL)
+		fatal("pagefile is not mapped");
+	/* Allocations grow the pagefile, earlier blocks must stay valid. */
+	for (i = 0; i < 8; i++) {
+		ptr[i] = xm_allocator_allocate(allocator, n * sizeof(double));
+		assert(ptr[i] != XM_NULL_PTR);
+		data = xm_allocator_get_data(allocator, ptr[i]);
+		for (j = 0; j < n; j++)
+			data[j] = (double)(i * n + j);
+		xm_allocator_prefetch(allocator, ptr[i], n * sizeof(double));
+	}
+	for (i = 0; i < 8; i++) {
+		data = xm_allocator_get_data(allocator, ptr[i]);
+		for (j = 0; j < n; j += n / 16)
+			if (data[j] != (double)(i * n + j))
+				fatal("data does not match");
+		xm_allocator_read(allocator, ptr[i], buf, sizeof buf);
+		for (j = 0; j < 16; j++)
+			if (buf[j] != (double)(i * n + j))
+				fatal("data does not match");
+		xm_allocator_deallocate(allocator, ptr[i]);
+	}
+	xm_allocator_destroy(allocator);
+}
+
 static void
 run_tests(const char *path, xm_scalar_type_t type)
 {
@@ -2060,6 +2095,10 @@ main(int argc, char **argv)
 	run_tests(NULL, XM_SCALAR_FLOAT_COMPLEX);
 	puts("Testing double complex...");
 	run_tests(NULL, XM_SCALAR_DOUBLE_COMPLEX);
+	printf("mapped allocator test... ");
+	fflush(stdout);
+	test_alloc_mapped(path);
+	printf("success\n");
 	puts("Testing float...");
 	run_tests(path, XM_SCALAR_FLOAT);
 	puts("Testing double...");
@@ -7,12 +7,21 @@ namespace libtensor {
 
 /** \brief Level-1 linear algebra operations (CBLAS)
 
+    Unit-stride vectors of up to k_simd_max elements are handled by the
+    vectorized kernels of linalg_simd_level1, which for short vectors are
+    faster than the CBLAS call. Operations that CBLAS does not cover are
+    always vectorized.
+
     \ingroup libtensor_linalg
  **/
 class linalg_cblas_level1 : public linalg_generic_level1 {
  public:
   static const char* k_clazz;  //!< Class name
 
+  enum {
+    k_simd_max = 512  //!< Longest vector handled without CBLAS
+  };
+
  public:
   static void add_i_i_x_x(void*, size_t ni, const double* a, size_t sia, double ka,
                           double b, double kb, double* c, size_t sic, double d);
@@ -27,6 +36,9 @@ class linalg_cblas_level1 : public linalg_generic_level1 {
 
   static void mul2_i_i_x(void*, size_t ni, const double* a, size_t sia, double b,
                          double* c, size_t sic);
+
+  static void mul2_i_i_i_x(void*, size_t ni, const double* a, size_t sia,
+                           const double* b, size_t sib, double* c, size_t sic, double d);
 };
 
 }  // namespace libtensor
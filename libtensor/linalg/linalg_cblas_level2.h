@@ -7,6 +7,9 @@ namespace libtensor {
 
 /** \brief Level-2 linear algebra operations (CBLAS)
 
+    Transpositions and the traces of matrix products, which CBLAS does not
+    provide, use the vectorized kernels of linalg_simd_level2.
+
     \ingroup libtensor_linalg
  **/
 class linalg_cblas_level2 : public linalg_generic_level2 {
@@ -14,9 +17,15 @@ class linalg_cblas_level2 : public linalg_generic_level2 {
   static const char* k_clazz;  //!< Class name
 
  public:
+  static void add1_ij_ji_x(void*, size_t ni, size_t nj, const double* a, size_t sja,
+                           double b, double* c, size_t sic);
+
   static void copy_ij_ji(void*, size_t ni, size_t nj, const double* a, size_t sja,
                          double* c, size_t sic);
 
+  static void copy_ij_ji_x(void*, size_t ni, size_t nj, const double* a, size_t sja,
+                           double b, double* c, size_t sic);
+
   static void mul2_i_ip_p_x(void*, size_t ni, size_t np, const double* a, size_t sia,
                             const double* b, size_t spb, double* c, size_t sic, double d);
 
@@ -25,6 +34,12 @@ class linalg_cblas_level2 : public linalg_generic_level2 {
 
   static void mul2_ij_i_j_x(void*, size_t ni, size_t nj, const double* a, size_t sia,
                             const double* b, size_t sjb, double* c, size_t sic, double d);
+
+  static double mul2_x_pq_pq(void*, size_t np, size_t nq, const double* a, size_t spa,
+                             const double* b, size_t spb);
+
+  static double mul2_x_pq_qp(void*, size_t np, size_t nq, const double* a, size_t spa,
+                             const double* b, size_t sqb);
 };
 
 }  // namespace libtensor
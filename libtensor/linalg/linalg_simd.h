@@ -0,0 +1,59 @@
+#ifndef LIBTENSOR_LINALG_SIMD_H
+#define LIBTENSOR_LINALG_SIMD_H
+
+#include "linalg_generic_level3.h"
+#include "linalg_simd_level1.h"
+#include "linalg_simd_level2.h"
+
+namespace libtensor {
+
+/** \brief Vectorized linear algebra implementation without CBLAS
+
+    Level-1 and level-2 operations are vectorized with run-time selection
+    of the instruction set (see linalg_simd_isa), level-3 operations use
+    the generic implementation.
+
+    \ingroup libtensor_linalg
+ **/
+class linalg_simd : public linalg_simd_level1,
+                    public linalg_simd_level2,
+                    public linalg_generic_level3 {
+
+ public:
+  typedef double element_type;        //!< Data type
+  typedef void* device_context_type;  //!< Device context
+  typedef void* device_context_ref;   //!< Reference type to device context
+
+  using linalg_simd_level1::k_clazz;
+  using linalg_simd_level1::add_i_i_x_x;
+  using linalg_simd_level1::copy_i_i;
+  using linalg_simd_level1::div1_i_i_x;
+  using linalg_simd_level1::mul1_i_x;
+  using linalg_simd_level1::mul2_x_p_p;
+  using linalg_simd_level1::mul2_i_i_x;
+  using linalg_simd_level1::mul2_i_i_i_x;
+  using linalg_simd_level1::rng_setup;
+  using linalg_simd_level1::rng_set_i_x;
+  using linalg_simd_level1::rng_add_i_x;
+
+  using linalg_simd_level2::add1_ij_ij_x;
+  using linalg_simd_level2::add1_ij_ji_x;
+  using linalg_simd_level2::copy_ij_ij_x;
+  using linalg_simd_level2::copy_ij_ji;
+  using linalg_simd_level2::copy_ij_ji_x;
+  using linalg_simd_level2::mul2_i_ip_p_x;
+  using linalg_simd_level2::mul2_i_pi_p_x;
+  using linalg_simd_level2::mul2_ij_i_j_x;
+  using linalg_simd_level2::mul2_x_pq_pq;
+  using linalg_simd_level2::mul2_x_pq_qp;
+
+  using linalg_generic_level3::mul2_i_ipq_qp_x;
+  using linalg_generic_level3::mul2_ij_ip_jp_x;
+  using linalg_generic_level3::mul2_ij_ip_pj_x;
+  using linalg_generic_level3::mul2_ij_pi_jp_x;
+  using linalg_generic_level3::mul2_ij_pi_pj_x;
+};
+
+}  // namespace libtensor
+
+#endif  // LIBTENSOR_LINALG_SIMD_H
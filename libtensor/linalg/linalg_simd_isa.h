@@ -0,0 +1,59 @@
+#ifndef LIBTENSOR_LINALG_SIMD_ISA_H
+#define LIBTENSOR_LINALG_SIMD_ISA_H
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define LIBTENSOR_SIMD_X86 1
+#endif
+
+namespace libtensor {
+
+/** \brief Selects the instruction set of the vectorized linear algebra
+        kernels
+
+    The instruction set is detected on first use from the CPU the program
+    runs on: AVX-512 if available, then AVX2 with FMA, otherwise plain
+    scalar loops. It can be lowered at run time with set(), for example to
+    compare the results of the different code paths. Requests for an
+    instruction set the CPU does not support are capped at the best
+    supported one.
+
+    \ingroup libtensor_linalg
+ **/
+class linalg_simd_isa {
+ public:
+  enum {
+    k_scalar = 0,  //!< Scalar loops
+    k_avx2   = 1,  //!< AVX2 and FMA
+    k_avx512 = 2   //!< AVX-512F
+  };
+
+ public:
+  /** \brief Returns the instruction set in use
+   **/
+  static int get() {
+    int isa = m_isa;
+    return isa >= 0 ? isa : init();
+  }
+
+  /** \brief Sets the instruction set, returns the one actually in use
+   **/
+  static int set(int isa);
+
+  /** \brief Returns the best instruction set supported by the CPU
+   **/
+  static int detect();
+
+  /** \brief Returns the name of an instruction set
+   **/
+  static const char* get_name(int isa);
+
+ private:
+  static int init();
+
+ private:
+  static volatile int m_isa;  //!< Instruction set in use (-1 if unknown)
+};
+
+}  // namespace libtensor
+
+#endif  // LIBTENSOR_LINALG_SIMD_ISA_H
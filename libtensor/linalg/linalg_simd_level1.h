@@ -0,0 +1,42 @@
+#ifndef LIBTENSOR_LINALG_SIMD_LEVEL1_H
+#define LIBTENSOR_LINALG_SIMD_LEVEL1_H
+
+#include "linalg_generic_level1.h"
+
+namespace libtensor {
+
+/** \brief Level-1 linear algebra operations (vectorized)
+
+    Operations on unit-stride vectors are vectorized using AVX-512 or AVX2
+    as selected by linalg_simd_isa, the other cases fall back to the generic
+    implementation. There is no call overhead beyond one branch, which makes
+    these functions preferable to CBLAS for short vectors.
+
+    \ingroup libtensor_linalg
+ **/
+class linalg_simd_level1 : public linalg_generic_level1 {
+ public:
+  static const char k_clazz[];  //!< Class name
+
+ public:
+  static void add_i_i_x_x(void*, size_t ni, const double* a, size_t sia, double ka,
+                          double b, double kb, double* c, size_t sic, double d);
+
+  static void copy_i_i(void*, size_t ni, const double* a, size_t sia, double* c,
+                       size_t sic);
+
+  static void mul1_i_x(void*, size_t ni, double a, double* c, size_t sic);
+
+  static double mul2_x_p_p(void*, size_t np, const double* a, size_t spa, const double* b,
+                           size_t spb);
+
+  static void mul2_i_i_x(void*, size_t ni, const double* a, size_t sia, double b,
+                         double* c, size_t sic);
+
+  static void mul2_i_i_i_x(void*, size_t ni, const double* a, size_t sia,
+                           const double* b, size_t sib, double* c, size_t sic, double d);
+};
+
+}  // namespace libtensor
+
+#endif  // LIBTENSOR_LINALG_SIMD_LEVEL1_H
@@ -0,0 +1,39 @@
+#ifndef LIBTENSOR_LINALG_SIMD_LEVEL2_H
+#define LIBTENSOR_LINALG_SIMD_LEVEL2_H
+
+#include "linalg_generic_level2.h"
+
+namespace libtensor {
+
+/** \brief Level-2 linear algebra operations (vectorized)
+
+    Transpositions are done in cache-sized tiles made up of 4x4 blocks
+    that are transposed in registers. The AVX2 kernels are used on CPUs
+    with AVX-512 as well.
+
+    \ingroup libtensor_linalg
+ **/
+class linalg_simd_level2 : public linalg_generic_level2 {
+ public:
+  static const char k_clazz[];  //!< Class name
+
+ public:
+  static void add1_ij_ji_x(void*, size_t ni, size_t nj, const double* a, size_t sja,
+                           double b, double* c, size_t sic);
+
+  static void copy_ij_ji(void*, size_t ni, size_t nj, const double* a, size_t sja,
+                         double* c, size_t sic);
+
+  static void copy_ij_ji_x(void*, size_t ni, size_t nj, const double* a, size_t sja,
+                           double b, double* c, size_t sic);
+
+  static double mul2_x_pq_pq(void*, size_t np, size_t nq, const double* a, size_t spa,
+                             const double* b, size_t spb);
+
+  static double mul2_x_pq_qp(void*, size_t np, size_t nq, const double* a, size_t spa,
+                             const double* b, size_t sqb);
+};
+
+}  // namespace libtensor
+
+#endif  // LIBTENSOR_LINALG_SIMD_LEVEL2_H
@@ -1,6 +1,8 @@
 #ifndef LIBTENSOR_SE_LABEL_IMPL_H
 #define LIBTENSOR_SE_LABEL_IMPL_H
 
+#include <ostream>
+#include <libutil/threads/auto_lock.h>
 #include <libutil/threads/tls.h>
 #include <libtensor/defs.h>
 #include <libtensor/core/abs_index.h>
@@ -34,6 +36,19 @@ template<size_t N, typename T>
 const char *se_label<N, T>::k_sym_type = "label";
 
 
+template<size_t N, typename T>
+se_label<N, T>::se_label(const se_label<N, T> &elem) :
+    m_blk_labels(elem.m_blk_labels), m_rule(elem.m_rule),
+    m_pt(product_table_container::get_instance().req_const_table(
+        elem.m_pt.get_id())),
+    m_allowedp(0) {
+
+    libutil::auto_lock<libutil::mutex> lock(elem.m_lock);
+    m_allowed = elem.m_allowed;
+    m_allowedp = m_allowed.get();
+}
+
+
 template<size_t N, typename T>
 void se_label<N, T>::set_rule(label_t intr) {
     
@@ -46,6 +61,7 @@ void se_label<N, T>::set_rule(label_t intr) {
 template<size_t N, typename T>
 void se_label<N, T>::set_rule(const label_set_t &intr) {
 
+    reset_allowed();
     m_rule.clear();
     if (intr.empty()) return;
 
@@ -61,6 +77,7 @@ void se_label<N, T>::set_rule(const label_set_t &intr) {
 template<size_t N, typename T>
 void se_label<N, T>::permute(const permutation<N> &p) {
 
+    reset_allowed();
     m_blk_labels.permute(p);
     eval_sequence_list<N> &sl = m_rule.get_sequences();
 
@@ -73,6 +90,17 @@ void se_label<N, T>::permute(const permutation<N> &p) {
 template<size_t N, typename T>
 bool se_label<N, T>::is_allowed(const index<N> &idx) const {
 
+    const bitmap_type *allowed = get_allowed();
+    if(allowed == 0) return eval_allowed(idx);
+
+    const dimensions<N> &bidims = m_blk_labels.get_block_index_dims();
+    return (*allowed)[abs_index<N>::get_abs_index(idx, bidims)];
+}
+
+
+template<size_t N, typename T>
+bool se_label<N, T>::eval_allowed(const index<N> &idx) const {
+
     product_table_i::label_group_t &lg = se_label_buffer::get_lg();
 
     // Loop over all products in the evaluation rule
@@ -112,6 +140,90 @@ bool se_label<N, T>::is_allowed(const index<N> &idx) const {
 }
 
 
+template<size_t N, typename T>
+const typename se_label<N, T>::bitmap_type *
+se_label<N, T>::get_allowed() const {
+
+    const bitmap_type *allowed = m_allowedp.load(std::memory_order_acquire);
+    if(allowed != 0) return allowed;
+
+    const dimensions<N> &bidims = m_blk_labels.get_block_index_dims();
+    size_t n = bidims.get_size();
+    if(n > size_t(k_max_bitmap)) return 0;
+
+    libutil::auto_lock<libutil::mutex> lock(m_lock);
+
+    if(!m_allowed) {
+        std::shared_ptr<bitmap_type> bm(new bitmap_type(n, false));
+        abs_index<N> ai(bidims);
+        do {
+            if(eval_allowed(ai.get_index())) (*bm)[ai.get_abs_index()] = true;
+        } while(ai.inc());
+        m_allowed = bm;
+    }
+    allowed = m_allowed.get();
+    m_allowedp.store(allowed, std::memory_order_release);
+    return allowed;
+}
+
+
+template<size_t N, typename T>
+void se_label<N, T>::reset_allowed() {
+
+    libutil::auto_lock<libutil::mutex> lock(m_lock);
+    m_allowedp.store(0, std::memory_order_relaxed);
+    m_allowed.reset();
+}
+
+
+template<size_t N, typename T>
+bool se_label<N, T>::get_key(std::ostream &os) const {
+
+    //  Block labels
+    const dimensions<N> &bidims = m_blk_labels.get_block_index_dims();
+    for(size_t i = 0; i < N; i++) {
+        size_t type = m_blk_labels.get_dim_type(i);
+        for(size_t j = 0; j < bidims[i]; j++) {
+            os << m_blk_labels.get_label(type, j) << ',';
+        }
+        os << ';';
+    }
+
+    //  Evaluation rule
+    for(typename evaluation_rule<N>::iterator it = m_rule.begin();
+        it != m_rule.end(); ++it) {
+
+        const product_rule<N> &pr = m_rule.get_product(it);
+        os << '(';
+        for(typename product_rule<N>::iterator ip = pr.begin();
+            ip != pr.end(); ++ip) {
+
+            const sequence<N, size_t> &seq = pr.get_sequence(ip);
+            for(size_t i = 0; i < N; i++) os << seq[i] << ',';
+            os << pr.get_intrinsic(ip) << ';';
+        }
+        os << ')';
+    }
+
+    //  Product table: the table may be modified under the same id, so
+    //  the products of all pairs of labels are included
+    os << m_pt.get_id() << ':';
+    size_t nl = m_pt.get_n_labels();
+    product_table_i::label_group_t lg(2);
+    product_table_i::label_set_t ls;
+    for(size_t i = 0; i < nl; i++) for(size_t j = i; j < nl; j++) {
+        lg[0] = i; lg[1] = j;
+        ls.clear();
+        m_pt.product(lg, ls);
+        for(product_table_i::label_set_t::const_iterator il = ls.begin();
+            il != ls.end(); ++il) os << *il << ',';
+        os << ';';
+    }
+
+    return true;
+}
+
+
 } // namespace libtensor
 
 #endif // LIBTENSOR_SE_LABEL_IMPL_H
@@ -2,6 +2,7 @@
 #define LIBTENSOR_SE_PART_IMPL_H
 
 #include <algorithm>
+#include <ostream>
 #include "../bad_symmetry.h"
 #include "../se_part.h"
 
@@ -400,6 +401,21 @@ void se_part<N, T>::apply(index<N> &idx, tensor_transf<N, T> &tr) const {
 }
 
 
+template<size_t N, typename T>
+bool se_part<N, T>::get_key(std::ostream &os) const {
+
+    for(size_t i = 0; i < N; i++) {
+        os << m_pdims[i] << ',' << m_bipdims[i] << ',';
+    }
+    for(size_t i = 0; i < m_fmap.size(); i++) {
+        if(m_fmap[i] == size_t(-1)) os << '-';
+        else os << m_fmap[i] << '/' << m_ftr[i];
+        os << ',';
+    }
+    return true;
+}
+
+
 template<size_t N, typename T>
 dimensions<N> se_part<N, T>::make_pdims(
     const block_index_space<N> &bis,
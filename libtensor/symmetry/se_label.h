@@ -1,6 +1,10 @@
 #ifndef LIBTENSOR_SE_LABEL_H
 #define LIBTENSOR_SE_LABEL_H
 
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <libutil/threads/mutex.h>
 #include <libtensor/core/symmetry_element_i.h>
 #include "block_labeling.h"
 #include "evaluation_rule.h"
@@ -31,6 +35,13 @@ namespace libtensor {
     the sequence of labels of a given block. For details please refer to the
     documentation of \sa evaluation_rule.
 
+    The first call to \c is_allowed() evaluates the rule for all the blocks
+    and stores the result in a bitmap over the block index space, which
+    answers all further calls. The bitmap is built once under a lock, shared
+    read-only with the copies of the element, and discarded when the labels
+    or the rule are modified. Block index spaces with more than
+    \c k_max_bitmap blocks are not tabulated.
+
     \ingroup libtensor_symmetry
  **/
 template<size_t N, typename T>
@@ -42,12 +53,24 @@ public:
     typedef product_table_i::label_t label_t;
     typedef product_table_i::label_set_t label_set_t;
 
+    enum {
+        k_max_bitmap = 1 << 24 //!< Max number of blocks in the bitmap
+    };
+
+private:
+    typedef std::vector<bool> bitmap_type;
+    typedef std::shared_ptr<const bitmap_type> bitmap_ptr;
+
 private:
     block_labeling<N> m_blk_labels; //!< Block index labels
     evaluation_rule<N> m_rule; //!< Label evaluation rule
 
     const product_table_i &m_pt; //!< Product table
 
+    mutable libutil::mutex m_lock; //!< Protects m_allowed
+    mutable bitmap_ptr m_allowed; //!< Bitmap of allowed blocks
+    mutable std::atomic<const bitmap_type*> m_allowedp; //!< Fast access
+
 public:
     //! \name Construction and destruction
     //@{
@@ -57,17 +80,14 @@ public:
      **/
     se_label(const dimensions<N> &bidims, const std::string &id) :
         m_blk_labels(bidims), 
-        m_pt(product_table_container::get_instance().req_const_table(id)) {
+        m_pt(product_table_container::get_instance().req_const_table(id)),
+        m_allowedp(0) {
     }
 
 
     /** \brief Copy constructor
      **/
-    se_label(const se_label<N, T> &elem) :
-        m_blk_labels(elem.m_blk_labels), m_rule(elem.m_rule),
-        m_pt(product_table_container::get_instance().req_const_table(
-                elem.m_pt.get_id())) {
-    }
+    se_label(const se_label<N, T> &elem);
 
 
     /** \brief Virtual destructor
@@ -83,7 +103,10 @@ public:
 
     /** \brief Obtain the block index labeling
      **/
-    block_labeling<N> &get_labeling() { return m_blk_labels; }
+    block_labeling<N> &get_labeling() {
+        reset_allowed();
+        return m_blk_labels;
+    }
 
     /** \brief Obtain the block index labeling (const version)
      **/
@@ -110,7 +133,10 @@ public:
         The function checks the validity of the given rule and replaces any
         previously given rule.
      **/
-    void set_rule(const evaluation_rule<N> &rule) { m_rule = rule; }
+    void set_rule(const evaluation_rule<N> &rule) {
+        reset_allowed();
+        m_rule = rule;
+    }
     //@}
 
     //! \name Access functions
@@ -165,8 +191,25 @@ public:
             index<N>&, transf<N, T>&)
      **/
     virtual void apply(index<N> &idx, tensor_transf<N, T> &tr) const { }
+
+    /** \copydoc symmetry_element_i<N, T>::get_key
+     **/
+    virtual bool get_key(std::ostream &os) const;
     //@}
 
+private:
+    /** \brief Evaluates the rule for one block
+     **/
+    bool eval_allowed(const index<N> &idx) const;
+
+    /** \brief Returns the bitmap of allowed blocks, builds it if necessary
+     **/
+    const bitmap_type *get_allowed() const;
+
+    /** \brief Discards the bitmap of allowed blocks
+     **/
+    void reset_allowed();
+
 };
 
 
@@ -180,6 +180,10 @@ public:
     **/
     virtual void apply(index<N> &idx, tensor_transf<N, T> &tr) const;
 
+    /** \copydoc symmetry_element_i<N, T>::get_key
+     **/
+    virtual bool get_key(std::ostream &os) const;
+
     //@}
 
 private:
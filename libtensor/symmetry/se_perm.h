@@ -111,6 +111,13 @@ public:
      **/
     virtual void apply(index<N> &idx, tensor_transf<N, T> &tr) const;
 
+    /** \copydoc symmetry_element_i<N, T>::get_key
+     **/
+    virtual bool get_key(std::ostream &os) const {
+        os << m_transf.get_perm() << m_transf.get_scalar_tr();
+        return true;
+    }
+
     //@}
 };
 
@@ -0,0 +1,41 @@
+#ifndef LIBUTIL_LPT_TASK_ITERATOR_H
+#define LIBUTIL_LPT_TASK_ITERATOR_H
+
+#include <vector>
+#include "task_iterator_i.h"
+
+namespace libutil {
+
+
+/** \brief Returns the tasks of another iterator in the order of decreasing
+        cost (longest processing time first)
+
+    All the tasks are taken from the underlying iterator on construction and
+    sorted by task_i::get_cost(). Tasks of equal cost keep their order.
+    Running the most expensive tasks first avoids a few large tasks being
+    left to the end while the other workers have nothing to do.
+
+    \ingroup libutil_thread_pool
+ **/
+class lpt_task_iterator : public task_iterator_i {
+private:
+    std::vector<task_i*> m_tasks; //!< Sorted tasks
+    size_t m_i; //!< Next task
+
+public:
+    /** \brief Takes and sorts the tasks of an iterator
+     **/
+    lpt_task_iterator(task_iterator_i &ti);
+
+    virtual ~lpt_task_iterator() { }
+
+    virtual bool has_more() const;
+
+    virtual task_i *get_next();
+
+};
+
+
+} // namespace libutil
+
+#endif // LIBUTIL_LPT_TASK_ITERATOR_H
@@ -1,6 +1,8 @@
 #ifndef LIBUTIL_TASK_I_H
 #define LIBUTIL_TASK_I_H
 
+#include <cstdlib> // for size_t
+
 namespace libutil {
 
 
@@ -18,6 +20,16 @@ public:
      **/
     virtual unsigned long get_cost() const = 0;
 
+    /** \brief Returns a key that identifies the data used by the task, or
+            zero if the task has no preference
+
+        Tasks from the same source that have the same non-zero key are
+        preferably run one after another by the same worker.
+     **/
+    virtual size_t get_affinity() const {
+        return 0;
+    }
+
     /** \brief Performs the task
      **/
     virtual void perform() = 0;
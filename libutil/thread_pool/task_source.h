@@ -1,10 +1,12 @@
 #ifndef LIBUTIL_TASK_SOURCE_H
 #define LIBUTIL_TASK_SOURCE_H
 
+#include <deque>
 #include <list>
 #include <libutil/exceptions/rethrowable_i.h>
 #include <libutil/threads/cond.h>
 #include <libutil/threads/mutex.h>
+#include <libutil/timings/timer.h>
 #include "task_info.h"
 #include "task_iterator_i.h"
 #include "task_observer_i.h"
@@ -23,17 +25,33 @@ namespace libutil {
     source from the root of the hierarchy using get_current() and then request
     tasks from that source using extract_task().
 
+    When a task with a given affinity key is requested (see
+    task_i::get_affinity()), the source looks ahead in the iterator for such
+    a task. The tasks skipped on the way are kept and given out first later.
+
+    The source records when its last task is given out. The time from that
+    moment until all the tasks are complete (the tail, during which workers
+    run out of tasks) is returned by get_tail_time().
+
     \ingroup libutil_thread_pool
  **/
 class task_source {
+private:
+    enum {
+        k_lookahead = 32 //!< Max number of tasks taken ahead of time
+    };
+
 private:
     task_source *m_parent; //!< Parent task source
     std::list<task_source*> m_children; //!< Children task sources
     const rethrowable_i *m_exc; //!< First exception
     task_iterator_i &m_ti; //!< Task iterator
     task_observer_i &m_to; //!< Task observer
+    std::deque<task_i*> m_ahead; //!< Tasks taken from the iterator ahead
     size_t m_npending; //!< Number of tasks about to be run
     size_t m_nrunning; //!< Number of currently running tasks
+    bool m_drained; //!< Whether the last task has been given out
+    time_pt_t m_tdrained; //!< When the last task was given out
     mutex m_mtx; //!< Mutex
     cond m_alldone; //!< All done signal
 
@@ -56,14 +74,20 @@ public:
      **/
     void rethrow_exceptions();
 
+    /** \brief Returns the time elapsed since the last task was given out
+            (zero if tasks remain)
+     **/
+    time_diff_t get_tail_time();
+
     /** \brief Returns the current task source or null if there are no sources
             with enqueued tasks
      **/
     task_source *get_current();
 
     /** \brief Returns the next task from the source
+        \param key Preferred affinity key of the task (zero for any task).
      **/
-    task_i *extract_task();
+    task_i *extract_task(size_t key = 0);
 
     /** \brief Notifies the task source that a task has been started
      **/
@@ -12,12 +12,25 @@ namespace libutil {
 
 /** \brief Steals tasks from workers' local queues
 
+    Each queue is registered together with the node (processor socket) its
+    worker last ran on. Victims on the same node as the thief are tried
+    first, so stolen tasks are more likely to find their data in a shared
+    cache.
+
     \ingroup libutil_thread_pool
  **/
 class task_thief {
 private:
-    std::map< std::deque<task_info>*, spinlock* > m_queues; //!< Victims
-    std::map< std::deque<task_info>*, spinlock* >::iterator m_i;
+    struct queue_info {
+        spinlock *mtx; //!< Lock on the queue
+        int node; //!< Node of the worker
+    };
+
+    typedef std::map< std::deque<task_info>*, queue_info > queue_map;
+
+private:
+    queue_map m_queues; //!< Victims
+    queue_map::iterator m_i; //!< Last victim
     spinlock m_mtx; //!< Lock
 
 public:
@@ -33,9 +46,22 @@ public:
      **/
     void unregister_queue(std::deque<task_info> &lq);
 
-    /** \brief Steals a task from one of the victims
+    /** \brief Updates the node of the worker that owns a queue
+     **/
+    void set_node(std::deque<task_info> &lq, int node);
+
+    /** \brief Steals a task from one of the victims, preferably from one
+            on the given node
      **/
-    void steal_task(task_info &tinfo);
+    void steal_task(task_info &tinfo, int node = 0);
+
+    /** \brief Returns the node (processor socket) of the CPU the current
+            thread is running on, or zero if unknown
+     **/
+    static int get_current_node();
+
+private:
+    bool steal_from(queue_map::iterator i, task_info &tinfo);
 
 };
 
@@ -43,4 +69,3 @@ public:
 } // namespace libutil
 
 #endif // LIBUTIL_TASK_THIEF_H
-
@@ -17,6 +17,12 @@ namespace libutil {
 
 /** \brief Thread pool
 
+    Workers fill their local queues with tasks from the current task source.
+    Unless disabled with set_affinity(), a worker asks the source for tasks
+    with the affinity key of its previous task (see task_i::get_affinity()),
+    so tasks that use the same data run on the same worker. Idle workers
+    steal tasks, preferably from workers on the same processor socket.
+
     \ingroup libutil_thread_pool
  **/
 class thread_pool {
@@ -52,6 +58,7 @@ private:
     std::map<task_source*, ts_stats> m_tsstat; //!< Task source stats
     task_thief m_thief; //!< Task thief
     volatile bool m_term; //!< Termination flag
+    volatile bool m_affinity; //!< Group tasks by affinity key
     spinlock m_mtx; //!< Mutex
 
 public:
@@ -79,6 +86,11 @@ public:
      **/
     void dissociate();
 
+    /** \brief Enables or disables grouping of tasks by affinity key
+            (enabled by default)
+     **/
+    void set_affinity(bool affinity);
+
     /** \brief Worker's main function (task loop)
         \param w Worker.
      **/
@@ -90,6 +102,14 @@ public:
      **/
     static void submit(task_iterator_i &ti, task_observer_i &to);
 
+    /** \brief Same as submit(task_iterator_i&, task_observer_i&), also
+            returns the tail time: the time from giving out the last task
+            until all the tasks have been completed, during which some
+            workers are left without tasks
+     **/
+    static void submit(task_iterator_i &ti, task_observer_i &to,
+        time_diff_t &tail);
+
     /** \brief Allocates a CPU for the current thread (and waits for one
             to become available if necessary)
      **/
@@ -103,11 +123,13 @@ public:
 private:
     static void run_serial(task_iterator_i &ti, task_observer_i &to);
 
-    void do_submit(task_iterator_i &ti, task_observer_i &to);
+    void do_submit(task_iterator_i &ti, task_observer_i &to,
+        time_diff_t &tail);
     void do_acquire_cpu(bool intask);
     void do_release_cpu(bool intask);
 
-    void enqueue_local(std::deque<task_info> &lq, size_t maxn, spinlock &lqmtx);
+    void enqueue_local(std::deque<task_info> &lq, size_t maxn, spinlock &lqmtx,
+        size_t &key);
 
     void create_idle_thread();
     void activate_idle_thread();
@@ -40,6 +40,12 @@ public:
      **/
     void stop_timer(const std::string &name);
 
+    /** \brief Saves a time measured elsewhere under a timer name
+        \param name Timer name.
+        \param t Time.
+     **/
+    void add_time(const std::string &name, const time_diff_t &t);
+
     /** \brief Returns true if the container is empty, false otherwise
      **/
     bool is_empty() const;
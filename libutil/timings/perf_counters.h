@@ -0,0 +1,114 @@
+#ifndef LIBUTIL_PERF_COUNTERS_H
+#define LIBUTIL_PERF_COUNTERS_H
+
+#include <atomic>
+#include <cstdlib> // for size_t
+#include <libutil/threads/tls.h>
+
+namespace libutil {
+
+
+/** \brief Values of the performance counters
+
+    \ingroup libutil_timings
+ **/
+struct perf_values {
+
+    unsigned long long m_cycles; //!< CPU cycles
+    unsigned long long m_instructions; //!< Instructions retired
+    unsigned long long m_llc_misses; //!< Last level cache misses
+    unsigned long long m_bytes; //!< Bytes allocated
+
+    perf_values() :
+        m_cycles(0), m_instructions(0), m_llc_misses(0), m_bytes(0) { }
+
+    perf_values &operator+=(const perf_values &v) {
+        m_cycles += v.m_cycles;
+        m_instructions += v.m_instructions;
+        m_llc_misses += v.m_llc_misses;
+        m_bytes += v.m_bytes;
+        return *this;
+    }
+
+    perf_values &operator-=(const perf_values &v) {
+        m_cycles -= v.m_cycles;
+        m_instructions -= v.m_instructions;
+        m_llc_misses -= v.m_llc_misses;
+        m_bytes -= v.m_bytes;
+        return *this;
+    }
+
+};
+
+
+/** \brief Hardware performance counters of the current thread
+
+    Once enabled, each timer reads the counters of its thread when it is
+    started and stopped, and the differences are accumulated per timer in
+    the thread-local timings store (see timing_record).
+
+    On Linux the CPU cycles, instructions and last level cache misses are
+    counted by perf_event_open() for the calling thread in user space only,
+    which does not require privileges. The counters are opened in each thread
+    on first use. Counters that cannot be opened (e.g. on other systems or in
+    virtual machines) read zero.
+
+    The bytes allocated are counted by the memory allocator through
+    add_allocated().
+
+    \ingroup libutil_timings
+ **/
+class perf_counters {
+private:
+    enum {
+        k_ncounters = 3 //!< Number of hardware counters
+    };
+
+private:
+    static std::atomic<bool> m_enabled; //!< Counters enabled
+    int m_fd[k_ncounters]; //!< Counter file descriptors
+    bool m_open; //!< Whether the counters have been opened
+    unsigned long long m_bytes; //!< Bytes allocated by this thread
+
+public:
+    /** \brief Initializes the counters of a thread (opened on first use)
+     **/
+    perf_counters();
+
+    /** \brief Closes the counters
+     **/
+    ~perf_counters();
+
+    /** \brief Enables or disables the counters (disabled by default)
+     **/
+    static void enable(bool en) {
+        m_enabled.store(en, std::memory_order_relaxed);
+    }
+
+    /** \brief Returns true if the counters are enabled
+     **/
+    static bool is_enabled() {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    /** \brief Reads the counters of the current thread (zero if disabled)
+     **/
+    static void read(perf_values &v);
+
+    /** \brief Adds to the number of bytes allocated by the current thread
+     **/
+    static void add_allocated(size_t bytes) {
+        if(is_enabled()) tls<perf_counters>::get_instance().get().m_bytes +=
+            bytes;
+    }
+
+private:
+    void open();
+    void do_read(perf_values &v);
+
+};
+
+
+} // namespace libutil
+
+#endif // LIBUTIL_PERF_COUNTERS_H
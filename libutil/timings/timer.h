@@ -5,6 +5,7 @@
 #include <ctime>
 #include <iostream>
 #include <libutil/exceptions/util_exceptions.h>
+#include "perf_counters.h"
 
 namespace libutil {
 
@@ -19,15 +20,20 @@ class timer {
 private:
 	time_pt_t m_start, m_end; //!< start and end time
 	bool m_started; //!< started flag
+	bool m_perf; //!< performance counters read
+	perf_values m_pstart, m_pend; //!< counters at start and end
 
 public:
 	/** \brief Default constructor
 	 **/
-	timer() : m_started(false) { }
+	timer() : m_started(false), m_perf(false) { }
 
 	/** \brief start the timer
 	 */
 	void start() {
+		m_perf = perf_counters::is_enabled();
+		if(m_perf) perf_counters::read(m_pstart);
+		m_pend = m_pstart;
 		m_start.now();
 		m_end = m_start;
 		m_started = true;
@@ -37,6 +43,7 @@ public:
 	 */
 	void stop()	{
 		m_end.now();
+		if(m_perf) perf_counters::read(m_pend);
 		m_started = false;
 
 #ifdef LIBUTIL_DEBUG
@@ -51,6 +58,18 @@ public:
 	time_diff_t duration() const {
 		return time_diff_t(m_start, m_end);
 	}
+
+	/** \brief retrieve the performance counters between start and stop
+			(zero if the counters were disabled at start)
+	 */
+	perf_values counters() const {
+		perf_values v;
+		if(m_perf) {
+			v = m_pend;
+			v -= m_pstart;
+		}
+		return v;
+	}
 };
 
 
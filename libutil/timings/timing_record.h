@@ -10,19 +10,24 @@ struct timing_record {
 
     time_diff_t m_total;
     size_t m_ncalls;
+    perf_values m_perf; //!< Performance counters
 
-    timing_record(const time_diff_t &t) : m_total(t), m_ncalls(1) {
+    timing_record(const time_diff_t &t,
+        const perf_values &p = perf_values()) :
+        m_total(t), m_ncalls(1), m_perf(p) {
 
     }
 
-    void add_call(const time_diff_t &t) {
+    void add_call(const time_diff_t &t, const perf_values &p = perf_values()) {
         m_ncalls++;
         m_total += t;
+        m_perf += p;
     }
 
     void add_calls(const timing_record &other) {
         m_ncalls += other.m_ncalls;
         m_total += other.m_total;
+        m_perf += other.m_perf;
     }
 
 };
@@ -61,6 +61,12 @@ protected:
      **/
     static void stop_timer(const char *name);
 
+    /** \brief Submits a time measured elsewhere to the global timings object
+        \param name Timer name.
+        \param t Time.
+     **/
+    static void add_time(const char *name, const time_diff_t &t);
+
 private:
     static void make_id(std::string &id, const std::string &name);
 
@@ -95,6 +101,12 @@ protected:
      **/
     static void stop_timer(const char *name) { }
 
+    /** \brief Submits a time measured elsewhere to the global timings object
+        \param name Timer name.
+        \param t Time.
+     **/
+    static void add_time(const char *name, const time_diff_t &t) { }
+
 };
 
 
@@ -132,6 +144,17 @@ void timings<T, Module, true>::stop_timer(const char *name) {
 }
 
 
+template<typename T, typename Module>
+void timings<T, Module, true>::add_time(const char *name,
+    const time_diff_t &t) {
+
+    std::string id;
+    make_id(id, name);
+
+    tls< local_timings_store<Module> >::get_instance().get().add_time(id, t);
+}
+
+
 template<typename T, typename Module>
 void timings<T, Module, true>::make_id(std::string &id,
     const std::string &name) {
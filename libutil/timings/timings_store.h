@@ -52,8 +52,16 @@ public:
     void print(std::ostream &os);
 
     /** \brief Prints the timings to an output stream in the CSV format
+        \param os Output stream.
+        \param delim Delimiter.
+        \param per_thread If true, one line per timer and thread, with
+            the thread number in the first column.
+
+        Columns: [thread,] timer, calls, user, system and wall time (s),
+        cycles, instructions, last level cache misses and bytes allocated
+        (see perf_counters; zero unless the counters are enabled).
      **/
-    void print_csv(std::ostream &os, char delim = ',');
+    void print_csv(std::ostream &os, char delim = ',', bool per_thread = false);
 
 };
 
@@ -62,9 +62,14 @@ private:
     void test_self_2();
     void test_self_3();
 
+    void test_cost_1();
+
+    void test_screen_1();
+
     void test_batch_1();
     void test_batch_2();
     void test_batch_3();
+    void test_batch_4();
 
 };
 
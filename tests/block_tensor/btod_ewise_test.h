@@ -0,0 +1,23 @@
+#ifndef LIBTENSOR_BTOD_EWISE_TEST_H
+#define LIBTENSOR_BTOD_EWISE_TEST_H
+
+#include <libtest/unit_test.h>
+
+namespace libtensor {
+
+/** \brief Tests the libtensor::btod_ewise class
+
+    \ingroup libtensor_tests_btod
+**/
+class btod_ewise_test : public libtest::unit_test {
+public:
+    virtual void perform();
+
+private:
+    void test_1(bool doadd);
+    void test_2();
+};
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BTOD_EWISE_TEST_H
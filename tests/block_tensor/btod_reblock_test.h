@@ -0,0 +1,24 @@
+#ifndef LIBTENSOR_BTOD_REBLOCK_TEST_H
+#define LIBTENSOR_BTOD_REBLOCK_TEST_H
+
+#include <libtest/unit_test.h>
+
+namespace libtensor {
+
+/** \brief Tests the libtensor::btod_reblock class
+
+    \ingroup libtensor_tests_btod
+**/
+class btod_reblock_test : public libtest::unit_test {
+public:
+    virtual void perform();
+
+private:
+    void test_1();
+    void test_2(bool merge);
+    void test_splits();
+};
+
+} // namespace libtensor
+
+#endif // LIBTENSOR_BTOD_REBLOCK_TEST_H
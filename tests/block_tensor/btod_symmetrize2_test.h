@@ -25,6 +25,7 @@ private:
     void test_6b(bool symm, bool label,
             bool part);
     void test_7();
+    void test_8(bool symm);
 
 };
 
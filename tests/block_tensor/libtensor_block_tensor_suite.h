@@ -20,6 +20,7 @@
 #include "btod_diagonalize_test.h"
 #include "btod_dirsum_test.h"
 #include "btod_dotprod_test.h"
+#include "btod_ewise_test.h"
 #include "btod_ewmult2_test.h"
 #include "btod_extract_test.h"
 #include "btod_import_raw_test.h"
@@ -28,6 +29,7 @@
 #include "btod_mult1_test.h"
 #include "btod_print_test.h"
 #include "btod_random_test.h"
+#include "btod_reblock_test.h"
 #include "btod_read_test.h"
 #include "btod_scale_test.h"
 #include "btod_select_test.h"
@@ -79,6 +81,7 @@ namespace libtensor {
     \li libtensor::btod_diagonalize_test
     \li libtensor::btod_dirsum_test
     \li libtensor::btod_dotprod_test
+    \li libtensor::btod_ewise_test
     \li libtensor::btod_ewmult2_test
     \li libtensor::btod_extract_test
     \li libtensor::btod_import_raw_test
@@ -87,6 +90,7 @@ namespace libtensor {
     \li libtensor::btod_mult1_test
     \li libtensor::btod_print_test
     \li libtensor::btod_random_test
+    \li libtensor::btod_reblock_test
     \li libtensor::btod_read_test
     \li libtensor::btod_scale_test
     \li libtensor::btod_select_test
@@ -130,6 +134,7 @@ private:
     unit_test_factory<btod_diagonalize_test> m_utf_btod_diagonalize;
     unit_test_factory<btod_dirsum_test> m_utf_btod_dirsum;
     unit_test_factory<btod_dotprod_test> m_utf_btod_dotprod;
+    unit_test_factory<btod_ewise_test> m_utf_btod_ewise;
     unit_test_factory<btod_ewmult2_test> m_utf_btod_ewmult2;
     unit_test_factory<btod_extract_test> m_utf_btod_extract;
     unit_test_factory<btod_import_raw_test> m_utf_btod_import_raw;
@@ -138,6 +143,7 @@ private:
     unit_test_factory<btod_mult1_test> m_utf_btod_mult1;
     unit_test_factory<btod_print_test> m_utf_btod_print;
     unit_test_factory<btod_random_test> m_utf_btod_random;
+    unit_test_factory<btod_reblock_test> m_utf_btod_reblock;
     unit_test_factory<btod_read_test> m_utf_btod_read;
     unit_test_factory<btod_scale_test> m_utf_btod_scale;
     unit_test_factory<btod_select_test> m_utf_btod_select;
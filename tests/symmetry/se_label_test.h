@@ -27,6 +27,8 @@ private:
             const std::string &table_id);
     void test_permute_2(
             const std::string &table_id);
+    void test_modify_1(
+            const std::string &table_id);
 
     using se_label_test_base::setup_pg_table;
     using se_label_test_base::check_allowed;